@@ -0,0 +1,452 @@
+//
+//  assetPack.h
+//  single file of GPU-ready mesh blobs and shader sources, memory mapped at
+//  startup so the data goes from the page cache straight to the driver
+//
+
+#ifndef assetPack_h
+#define assetPack_h
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "meshKey.h"
+#include "vertexFormat.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+// minwindef.h defines these as empty macros, which breaks any variable of that name
+#undef near
+#undef far
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// packs written by another layout are ignored and rewritten
+const uint32_t ASSET_PACK_VERSION = 3;
+// bump whenever a mesh generator, the vertex cache optimizer or a vertex format
+// changes what it produces; packs made by another one are ignored and rewritten
+const uint32_t MESH_GENERATOR_VERSION = 1;
+const char* const ASSET_PACK_PATH = "assets.pack";
+// blobs start on this boundary inside the file
+const uint64_t ASSET_PACK_ALIGNMENT = 16;
+
+enum AssetKind
+{
+    ASSET_MESH,
+    ASSET_SHADER
+};
+
+// size and modification time of a file, what a packed shader is checked against
+struct FileStamp
+{
+    uint64_t bytes = 0;
+    int64_t modified = 0;
+
+    bool operator==(const FileStamp& other) const { return bytes == other.bytes && modified == other.modified; }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+
+    // all zero if the file cannot be found
+    static FileStamp of(const char* path)
+    {
+        FileStamp stamp;
+#ifdef _WIN32
+        struct _stat64 info;
+        if (_stat64(path, &info) != 0)
+            return stamp;
+#else
+        struct stat info;
+        if (::stat(path, &info) != 0)
+            return stamp;
+#endif
+        stamp.bytes = (uint64_t)info.st_size;
+        stamp.modified = (int64_t)info.st_mtime;
+        return stamp;
+    }
+};
+
+// file layout: header, entry table, then the blobs the entries point at
+struct AssetPackHeader
+{
+    char magic[8];                          // "ASSETPK\0"
+    uint32_t version;
+    uint32_t generatorVersion;              // MESH_GENERATOR_VERSION of the meshes
+    uint32_t entryCount;
+    uint32_t reserved;                      // pads the header to the entries' alignment
+};
+
+struct AssetPackEntry
+{
+    uint32_t kind;                          // AssetKind
+    uint32_t vertexFormat;                  // VertexFormat of the vertex blob
+    uint32_t indexType;                     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t reserved;
+    MeshKey key;                            // meshes only
+    char name[128];                         // shaders only, the path they were loaded from
+    uint64_t sourceBytes;                   // shaders only, the FileStamp of that file
+    int64_t sourceModified;
+    uint64_t dataOffset;                    // vertex blob or shader source, from the start of the file
+    uint64_t dataBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+};
+
+// the entry table is read in place from the mapping, right after the header
+static_assert(sizeof(AssetPackHeader) % alignof(AssetPackEntry) == 0, "asset pack entries would be misaligned");
+
+class AssetPack
+{
+public:
+    AssetPack() {}
+
+    ~AssetPack()
+    {
+        close();
+    }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // maps the file read only; false if it is missing, not a pack of this version or
+    // its meshes were made by other generators
+    bool open(const char* path)
+    {
+        close();
+        if (!mapFile(path))
+            return false;
+
+        const AssetPackHeader* header = (const AssetPackHeader*)base;
+        bool valid = size >= sizeof(AssetPackHeader) && memcmp(header->magic, "ASSETPK", 8) == 0
+            && header->version == ASSET_PACK_VERSION && header->generatorVersion == MESH_GENERATOR_VERSION
+            && size >= sizeof(AssetPackHeader) + (uint64_t)header->entryCount * sizeof(AssetPackEntry);
+        if (valid)
+        {
+            entries = (const AssetPackEntry*)(base + sizeof(AssetPackHeader));
+            entryCount = header->entryCount;
+            for (uint32_t i = 0; i < entryCount && valid; ++i)
+            {
+                valid = entries[i].dataOffset + entries[i].dataBytes <= size
+                    && entries[i].indexOffset + entries[i].indexBytes <= size;
+            }
+        }
+        if (!valid)
+        {
+            cout << "asset pack: " << path << " is stale or damaged, ignoring it" << endl;
+            close();
+            return false;
+        }
+        cout << "asset pack: " << path << ", " << entryCount << " entries" << endl;
+        return true;
+    }
+
+    void close()
+    {
+        if (base != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(base);
+            CloseHandle(mapping);
+            CloseHandle(file);
+#else
+            munmap((void*)base, size);
+#endif
+        }
+        base = nullptr;
+        size = 0;
+        entries = nullptr;
+        entryCount = 0;
+        misses = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+
+    // null, and counted as a miss, if the pack does not have it
+    const AssetPackEntry* findMesh(const MeshKey& key, VertexFormat format) const
+    {
+        for (uint32_t i = 0; i < entryCount; ++i)
+        {
+            if (entries[i].kind == ASSET_MESH && entries[i].key == key && entries[i].vertexFormat == (uint32_t)format)
+                return &entries[i];
+        }
+        ++misses;
+        return nullptr;
+    }
+
+    // also a miss if the file on disk is not the one that was packed
+    const AssetPackEntry* findShader(const char* path) const
+    {
+        for (uint32_t i = 0; i < entryCount; ++i)
+        {
+            if (entries[i].kind != ASSET_SHADER || strncmp(entries[i].name, path, sizeof(entries[i].name)) != 0)
+                continue;
+            FileStamp packed;
+            packed.bytes = entries[i].sourceBytes;
+            packed.modified = entries[i].sourceModified;
+            if (FileStamp::of(path) == packed)
+                return &entries[i];
+            cout << "asset pack: " << path << " changed since it was packed, reading the file" << endl;
+            break;
+        }
+        ++misses;
+        return nullptr;
+    }
+
+    // whether anything had to come from elsewhere, so the pack should be written again
+    bool hasMisses() const { return misses != 0; }
+
+    // every mesh entry, to carry over into a rewritten pack
+    uint32_t getEntryCount() const { return entryCount; }
+    const AssetPackEntry& entry(uint32_t i) const { return entries[i]; }
+
+    // pointers into the mapping, valid until close()
+    const void* data(const AssetPackEntry& entry) const { return base + entry.dataOffset; }
+    const void* indexData(const AssetPackEntry& entry) const { return base + entry.indexOffset; }
+
+    // the pack the mesh cache and the shaders read from, null for none
+    static AssetPack* current()
+    {
+        return currentPack();
+    }
+
+    static void setCurrent(AssetPack* pack)
+    {
+        currentPack() = pack;
+    }
+
+private:
+    bool mapFile(const char* path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (base == nullptr)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+        size = (uint64_t)fileSize.QuadPart;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);                        // the mapping keeps the file alive
+        if (mapped == MAP_FAILED)
+            return false;
+        base = (const unsigned char*)mapped;
+        size = (uint64_t)info.st_size;
+#endif
+        return true;
+    }
+
+    static AssetPack*& currentPack()
+    {
+        static AssetPack* pack = nullptr;
+        return pack;
+    }
+
+    const unsigned char* base = nullptr;
+    uint64_t size = 0;
+    const AssetPackEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+    mutable unsigned int misses = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+// collects entries and writes them out in the layout AssetPack maps
+class AssetPackWriter
+{
+public:
+    void addMesh(const MeshKey& key, VertexFormat format, GLenum indexType, unsigned int vertexCount, unsigned int indexCount,
+        vector<unsigned char>&& vertexData, vector<unsigned char>&& indexData)
+    {
+        Pending pending = {};
+        pending.entry.kind = ASSET_MESH;
+        pending.entry.vertexFormat = format;
+        pending.entry.indexType = indexType;
+        pending.entry.vertexCount = vertexCount;
+        pending.entry.indexCount = indexCount;
+        pending.entry.key = key;
+        pending.data = std::move(vertexData);
+        pending.indices = std::move(indexData);
+        entries.push_back(std::move(pending));
+    }
+
+    bool hasMesh(const MeshKey& key, VertexFormat format) const
+    {
+        for (const Pending& pending : entries)
+        {
+            if (pending.entry.kind == ASSET_MESH && pending.entry.key == key && pending.entry.vertexFormat == (uint32_t)format)
+                return true;
+        }
+        return false;
+    }
+
+    // the meshes of an older pack that were not added yet, so a run that never asked
+    // for some of them does not drop them from the rewritten pack
+    void addMeshesFrom(const AssetPack& pack)
+    {
+        for (uint32_t i = 0; i < pack.getEntryCount(); ++i)
+        {
+            const AssetPackEntry& entry = pack.entry(i);
+            if (entry.kind != ASSET_MESH || hasMesh(entry.key, (VertexFormat)entry.vertexFormat))
+                continue;
+            const unsigned char* vertices = (const unsigned char*)pack.data(entry);
+            const unsigned char* indices = (const unsigned char*)pack.indexData(entry);
+            addMesh(entry.key, (VertexFormat)entry.vertexFormat, (GLenum)entry.indexType, entry.vertexCount, entry.indexCount,
+                vector<unsigned char>(vertices, vertices + entry.dataBytes), vector<unsigned char>(indices, indices + entry.indexBytes));
+        }
+    }
+
+    void addShader(const char* path, const string& source, const FileStamp& stamp)
+    {
+        if (strlen(path) >= sizeof(AssetPackEntry::name))
+            return;
+        Pending pending = {};
+        pending.entry.kind = ASSET_SHADER;
+        memcpy(pending.entry.name, path, strlen(path));
+        pending.entry.sourceBytes = stamp.bytes;
+        pending.entry.sourceModified = stamp.modified;
+        pending.data.assign(source.begin(), source.end());
+        entries.push_back(std::move(pending));
+    }
+
+    // the file as it is on disk; skipped if it cannot be read
+    void addShaderFile(const char* path)
+    {
+        FileStamp stamp = FileStamp::of(path);
+        ifstream in(path, ios::binary);
+        if (!in)
+            return;
+        string source((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        addShader(path, source, stamp);
+    }
+
+    bool write(const char* path)
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out)
+        {
+            cout << "asset pack: cannot write " << path << endl;
+            return false;
+        }
+
+        // assign the blob offsets, then write everything in file order
+        uint64_t offset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+        for (Pending& pending : entries)
+        {
+            offset = align(offset);
+            pending.entry.dataOffset = offset;
+            pending.entry.dataBytes = pending.data.size();
+            offset = align(offset + pending.data.size());
+            pending.entry.indexOffset = offset;
+            pending.entry.indexBytes = pending.indices.size();
+            offset += pending.indices.size();
+        }
+
+        AssetPackHeader header = {};
+        memcpy(header.magic, "ASSETPK", 8);
+        header.version = ASSET_PACK_VERSION;
+        header.generatorVersion = MESH_GENERATOR_VERSION;
+        header.entryCount = (uint32_t)entries.size();
+        out.write((const char*)&header, sizeof(header));
+        for (const Pending& pending : entries)
+            out.write((const char*)&pending.entry, sizeof(AssetPackEntry));
+
+        uint64_t written = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+        for (const Pending& pending : entries)
+        {
+            pad(out, written, pending.entry.dataOffset);
+            writeBlob(out, written, pending.data);
+            pad(out, written, pending.entry.indexOffset);
+            writeBlob(out, written, pending.indices);
+        }
+        out.close();
+        bool ok = !out.fail();
+        if (!ok)
+        {
+            cout << "asset pack: writing " << path << " failed" << endl;
+            remove(path);
+        }
+        else
+            cout << "asset pack: wrote " << entries.size() << " entries, " << written << " bytes to " << path << endl;
+        return ok;
+    }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Pending
+    {
+        AssetPackEntry entry;
+        vector<unsigned char> data;
+        vector<unsigned char> indices;
+    };
+
+    static uint64_t align(uint64_t offset)
+    {
+        return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+    }
+
+    static void pad(ofstream& out, uint64_t& written, uint64_t target)
+    {
+        static const char zeros[ASSET_PACK_ALIGNMENT] = {};
+        out.write(zeros, (streamsize)(target - written));
+        written = target;
+    }
+
+    static void writeBlob(ofstream& out, uint64_t& written, const vector<unsigned char>& blob)
+    {
+        out.write((const char*)blob.data(), (streamsize)blob.size());
+        written += blob.size();
+    }
+
+    vector<Pending> entries;
+};
+
+#endif /* assetPack_h */
@@ -1,85 +1,76 @@
 #ifndef CONE_H
 #define CONE_H
 
-#include <glad/glad.h>
-#include <vector>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include "shader.h"
+#include "primitive.h"
 
-#define PI 3.1416
+// tessellation of a default constructed Cone, baked at compile time
+constexpr float DEFAULT_CONE_RADIUS = 1.0f;
+constexpr float DEFAULT_CONE_HEIGHT = 2.0f;
+constexpr int DEFAULT_CONE_SECTOR_COUNT = 20;
 
-using namespace std;
+// bottom disc facing down plus the sides fanning out from the apex; the sides reuse
+// the bottom circle
+struct ConeGeometry
+{
+    typedef UprightLayout Layout;
+
+    static constexpr unsigned int vertexCount(int sectorCount)
+    {
+        return SurfaceTopology::ringVertexCount(sectorCount) + 2;
+    }
+
+    static constexpr unsigned int indexCount(int sectorCount)
+    {
+        return 2 * SurfaceTopology::fanIndexCount(sectorCount);
+    }
+
+    template <typename Surface>
+    static constexpr void generate(Surface& surface, float radius, float height)
+    {
+        unsigned int center = surface.point(0.0f, -1.0f);
+        unsigned int circle = surface.ring(radius, 0.0f, 0.0f, -1.0f);
+        unsigned int apex = surface.point(height, 1.0f);
+
+        surface.fan(center, circle, false);
+        surface.fan(apex, circle, false);
+    }
+};
 
-class Cone
+class Cone : public Primitive
 {
 public:
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-    float shininess;
-
     // Constructor
-    Cone(float radius = 1.0f, float height = 2.0f, int sectorCount = 20, glm::vec3 amb = glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3 diff = glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3 spec = glm::vec3(0.5f, 0.5f, 0.5f), float shiny = 32.0f)
+    Cone(float radius = DEFAULT_CONE_RADIUS, float height = DEFAULT_CONE_HEIGHT, int sectorCount = DEFAULT_CONE_SECTOR_COUNT, glm::vec3 amb = glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3 diff = glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3 spec = glm::vec3(0.5f, 0.5f, 0.5f), float shiny = 32.0f)
     {
         set(radius, height, sectorCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        // Create VAO
-        glGenVertexArrays(1, &coneVAO);
-        glBindVertexArray(coneVAO);
-
-        // Create VBO
-        unsigned int coneVBO;
-        glGenBuffers(1, &coneVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, coneVBO);
-        glBufferData(GL_ARRAY_BUFFER, this->getVertexSize(), this->getVertices(), GL_STATIC_DRAW);
-
-        // Create EBO
-        unsigned int coneEBO;
-        glGenBuffers(1, &coneEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, coneEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->getIndexSize(), this->getIndices(), GL_STATIC_DRAW);
-
-        // Enable attributes
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, verticesStride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, verticesStride, (void*)(sizeof(float) * 3));
-
-        glBindVertexArray(0);
+        setBoundingSphere(glm::vec3(0.0f, this->height / 2, 0.0f), sqrtf(this->radius * this->radius + this->height * this->height / 4));
+        createMesh(meshKey(this->radius, this->height, this->sectorCount), &buildMesh, defaultKey(), defaultTable());
     }
 
     ~Cone() {}
 
-    void drawCone(Shader& lightingShader, glm::mat4 model) const
+    // the key a Cone built with these arguments uses
+    static MeshKey meshKey(float radius, float height, int sectors)
     {
-        lightingShader.use();
-
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
+        return MeshKey{ MESH_CONE, radius, 0.0f, height, sectors > 3 ? sectors : 3, 0 };
+    }
 
-        lightingShader.setMat4("model", model);
+    // starts generating the geometry of such a Cone on the worker pool, ahead of its construction
+    static void prefetch(float radius = DEFAULT_CONE_RADIUS, float height = DEFAULT_CONE_HEIGHT, int sectors = DEFAULT_CONE_SECTOR_COUNT)
+    {
+        MeshKey key = meshKey(radius, height, sectors);
+        prefetchMesh(key, &buildMesh, key == defaultKey());
+    }
 
-        glBindVertexArray(coneVAO);
-        glDrawElements(GL_TRIANGLES, this->getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+    void drawCone(Shader& lightingShader, glm::mat4 model) const
+    {
+        drawPrimitive(lightingShader, model);
     }
 
 private:
-    unsigned int coneVAO;
     float radius;
     float height;
     int sectorCount;
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    int verticesStride = 24;
 
     void set(float radius, float height, int sectorCount, glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
     {
@@ -92,80 +83,27 @@ private:
         this->shininess = shiny;
     }
 
-    void buildCoordinatesAndIndices()
+    static void buildMesh(const MeshKey& key, vector<float>& vertices, vector<unsigned int>& indices)
     {
-        float sectorStep = 2 * PI / sectorCount;
-        float sectorAngle = 0.0f;
-
-        // Bottom center
-        coordinates.push_back(0.0f);
-        coordinates.push_back(0.0f);
-        coordinates.push_back(0.0f);
-        normals.push_back(0.0f);
-        normals.push_back(-1.0f);
-        normals.push_back(0.0f);
-
-        // Bottom circle
-        for (int i = 0; i <= sectorCount; ++i)
-        {
-            sectorAngle = i * sectorStep;
-            float x = radius * cosf(sectorAngle);
-            float z = radius * sinf(sectorAngle);
-            coordinates.push_back(x);
-            coordinates.push_back(0.0f);
-            coordinates.push_back(z);
-            normals.push_back(0.0f);
-            normals.push_back(-1.0f);
-            normals.push_back(0.0f);
-        }
-
-        // Top (apex) of the cone
-        coordinates.push_back(0.0f);
-        coordinates.push_back(height);
-        coordinates.push_back(0.0f);
-        normals.push_back(0.0f);
-        normals.push_back(1.0f);
-        normals.push_back(0.0f);
-
-        // Indices for bottom circle
-        for (int i = 1; i <= sectorCount; ++i)
-        {
-            indices.push_back(0);
-            indices.push_back(i);
-            indices.push_back(i + 1);
-        }
-
-        // Indices for cone sides
-        int apexIndex = coordinates.size() / 3 - 1;
-        for (int i = 1; i <= sectorCount; ++i)
-        {
-            indices.push_back(i);
-            indices.push_back(i + 1);
-            indices.push_back(apexIndex);
-        }
+        vertices.resize((size_t)ConeGeometry::vertexCount(key.sectorCount) * 6);
+        indices.resize(ConeGeometry::indexCount(key.sectorCount));
+        SurfaceOfRevolution<UprightLayout> surface(key.sectorCount, 2 * PI, vertices.data(), indices.data());
+        ConeGeometry::generate(surface, key.radius, key.height);
     }
 
-    void buildVertices()
+    static MeshKey defaultKey()
     {
-        size_t count = coordinates.size();
-        for (size_t i = 0; i < count; i += 3)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+        return meshKey(DEFAULT_CONE_RADIUS, DEFAULT_CONE_HEIGHT, DEFAULT_CONE_SECTOR_COUNT);
     }
 
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
-    const float* getVertices() const { return vertices.data(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
+    typedef GeometryTable<ConeGeometry::vertexCount(DEFAULT_CONE_SECTOR_COUNT), ConeGeometry::indexCount(DEFAULT_CONE_SECTOR_COUNT)> DefaultTable;
+
+    static const DefaultTable& defaultTable()
+    {
+        static constexpr DefaultTable table = makeGeometryTable<ConeGeometry, DefaultTable>(
+            DEFAULT_CONE_SECTOR_COUNT, 2 * PI, DEFAULT_CONE_RADIUS, DEFAULT_CONE_HEIGHT);
+        return table;
+    }
 };
 
 #endif /* CONE_H */
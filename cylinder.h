@@ -5,69 +5,98 @@
 #ifndef cylinder_h
 #define cylinder_h
 
-#include <glad/glad.h>
-#include <vector>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include "shader.h"
-
-#define PI 3.1416
-
-using namespace std;
+#include "primitive.h"
 
 const int MIN_CYL_SECTOR_COUNT = 3;
 const int MIN_CYL_STACK_COUNT = 1;
 
-class Cylinder
+// tessellation of a default constructed Cylinder, baked at compile time
+constexpr float DEFAULT_CYL_BASE_RADIUS = 1.0f;
+constexpr float DEFAULT_CYL_TOP_RADIUS = 1.0f;
+constexpr float DEFAULT_CYL_HEIGHT = 2.0f;
+constexpr int DEFAULT_CYL_SECTOR_COUNT = 20;
+constexpr int DEFAULT_CYL_STACK_COUNT = 1;
+
+// side rings from the base to the top with normals pointing straight out, plus a
+// cap at either end whose radius is not zero; the layout picks the axis
+template <typename SurfaceLayout>
+struct CylinderGeometry
 {
-public:
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-    float shininess;
+    typedef SurfaceLayout Layout;
+
+    static constexpr int capCount(float baseRadius, float topRadius)
+    {
+        return (topRadius > 0.0f ? 1 : 0) + (baseRadius > 0.0f ? 1 : 0);
+    }
+
+    static constexpr unsigned int vertexCount(int sectorCount, int stackCount, int caps)
+    {
+        return (stackCount + 1 + caps) * SurfaceTopology::ringVertexCount(sectorCount) + caps;
+    }
+
+    static constexpr unsigned int indexCount(int sectorCount, int stackCount, int caps)
+    {
+        return SurfaceTopology::stripIndexCount(sectorCount, stackCount, false, false) + caps * SurfaceTopology::fanIndexCount(sectorCount);
+    }
+
+    template <typename Surface>
+    static constexpr void generate(Surface& surface, float baseRadius, float topRadius, float height, int stackCount)
+    {
+        float stackStep = height / stackCount;
+        for (int i = 0; i <= stackCount; ++i)
+        {
+            float radius = baseRadius + (topRadius - baseRadius) * i / stackCount;
+            surface.ring(radius, -height / 2 + i * stackStep, 1.0f, 0.0f);
+        }
+        surface.strip(0, stackCount, false, false);
+
+        if (topRadius > 0.0f)
+        {
+            unsigned int center = surface.point(height / 2, 1.0f);
+            unsigned int circle = surface.ring(topRadius, height / 2, 0.0f, 1.0f);
+            surface.fan(center, circle, false);
+        }
+
+        if (baseRadius > 0.0f)
+        {
+            unsigned int center = surface.point(-height / 2, -1.0f);
+            unsigned int circle = surface.ring(baseRadius, -height / 2, 0.0f, -1.0f);
+            surface.fan(center, circle, true);
+        }
+    }
+};
 
-    Cylinder(float baseRadius = 1.0f, float topRadius = 1.0f, float height = 2.0f,
-        int sectorCount = 20, int stackCount = 1,
+class Cylinder : public Primitive
+{
+public:
+    Cylinder(float baseRadius = DEFAULT_CYL_BASE_RADIUS, float topRadius = DEFAULT_CYL_TOP_RADIUS, float height = DEFAULT_CYL_HEIGHT,
+        int sectorCount = DEFAULT_CYL_SECTOR_COUNT, int stackCount = DEFAULT_CYL_STACK_COUNT,
         glm::vec3 amb = glm::vec3(0.0f, 1.0f, 1.0f), glm::vec3 diff = glm::vec3(0.0f, 1.0f, 1.0f),
         glm::vec3 spec = glm::vec3(0.5f, 0.5f, 1.0f), float shiny = 32.0f)
-        : verticesStride(24)
     {
         set(baseRadius, topRadius, height, sectorCount, stackCount, amb, diff, spec, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &cylinderVAO);
-        glBindVertexArray(cylinderVAO);
-
-        // Create VBO
-        unsigned int cylinderVBO;
-        glGenBuffers(1, &cylinderVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, cylinderVBO);
-        glBufferData(GL_ARRAY_BUFFER, getVertexSize(), getVertices(), GL_STATIC_DRAW);
-
-        // Create EBO
-        unsigned int cylinderEBO;
-        glGenBuffers(1, &cylinderEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cylinderEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, getIndexSize(), getIndices(), GL_STATIC_DRAW);
-
-        // Enable attribute arrays
-        glEnableVertexAttribArray(0); // Position
-        glEnableVertexAttribArray(1); // Normal
-
-        // Set attribute pointers
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, verticesStride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, verticesStride, (void*)(sizeof(float) * 3));
-
-        // Unbind VAO and buffers
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        setBoundingSphere(glm::vec3(0.0f), sqrtf(max(this->baseRadius, this->topRadius) * max(this->baseRadius, this->topRadius) + this->height * this->height / 4));
+        createMesh(meshKey(this->baseRadius, this->topRadius, this->height, this->sectorCount, this->stackCount),
+            &buildMesh, defaultKey(), defaultTable());
     }
 
     ~Cylinder() {}
 
+    // the key a Cylinder built with these arguments uses
+    static MeshKey meshKey(float baseRadius, float topRadius, float height, int sectors, int stacks)
+    {
+        return MeshKey{ MESH_CYLINDER, baseRadius, topRadius, height,
+            max(sectors, MIN_CYL_SECTOR_COUNT), max(stacks, MIN_CYL_STACK_COUNT) };
+    }
+
+    // starts generating the geometry of such a Cylinder on the worker pool, ahead of its construction
+    static void prefetch(float baseRadius = DEFAULT_CYL_BASE_RADIUS, float topRadius = DEFAULT_CYL_TOP_RADIUS, float height = DEFAULT_CYL_HEIGHT,
+        int sectors = DEFAULT_CYL_SECTOR_COUNT, int stacks = DEFAULT_CYL_STACK_COUNT)
+    {
+        MeshKey key = meshKey(baseRadius, topRadius, height, sectors, stacks);
+        prefetchMesh(key, &buildMesh, key == defaultKey());
+    }
+
     void set(float baseRadius, float topRadius, float height, int sectors, int stacks,
         glm::vec3 amb, glm::vec3 diff, glm::vec3 spec, float shiny)
     {
@@ -82,154 +111,41 @@ public:
         this->shininess = shiny;
     }
 
-    unsigned int getVertexCount() const { return (unsigned int)coordinates.size() / 3; }
-    unsigned int getVertexSize() const { return (unsigned int)vertices.size() * sizeof(float); }
-    int getVerticesStride() const { return verticesStride; }
-    const float* getVertices() const { return vertices.data(); }
-    unsigned int getIndexSize() const { return (unsigned int)indices.size() * sizeof(unsigned int); }
-    const unsigned int* getIndices() const { return indices.data(); }
-    unsigned int getIndexCount() const { return (unsigned int)indices.size(); }
-
     void drawCylinder(Shader& lightingShader, glm::mat4 model) const
     {
-        lightingShader.use();
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setFloat("material.shininess", this->shininess);
-        lightingShader.setMat4("model", model);
-
-        glBindVertexArray(cylinderVAO);
-        glDrawElements(GL_TRIANGLES, getIndexCount(), GL_UNSIGNED_INT, (void*)0);
-        glBindVertexArray(0);
+        drawPrimitive(lightingShader, model);
     }
 
 private:
-    void buildCoordinatesAndIndices()
-    {
-        float sectorStep = 2 * PI / sectorCount;
-        float stackStep = height / stackCount;
-        float sectorAngle;
-
-        // Generate coordinates
-        for (int i = 0; i <= stackCount; ++i)
-        {
-            float y = -height / 2 + i * stackStep; // Height along y-axis
-            float radius = baseRadius + (topRadius - baseRadius) * i / stackCount;
-
-            for (int j = 0; j <= sectorCount; ++j)
-            {
-                sectorAngle = j * sectorStep;
-
-                float x = radius * cosf(sectorAngle);
-                float z = radius * sinf(sectorAngle); // Use z as the circular base
-
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                glm::vec3 normal = glm::normalize(glm::vec3(x, 0.0f, z)); // Adjust normal
-                normals.push_back(normal.x);
-                normals.push_back(normal.y);
-                normals.push_back(normal.z);
-            }
-        }
-
-        // Generate indices
-        int k1, k2;
-        for (int i = 0; i < stackCount; ++i)
-        {
-            k1 = i * (sectorCount + 1);
-            k2 = k1 + sectorCount + 1;
-
-            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
-            {
-                indices.push_back(k1);
-                indices.push_back(k2);
-                indices.push_back(k1 + 1);
-
-                indices.push_back(k1 + 1);
-                indices.push_back(k2);
-                indices.push_back(k2 + 1);
-            }
-        }
+    typedef CylinderGeometry<UprightLayout> Geometry;
 
-        // Generate caps
-        if (topRadius > 0.0f)
-            buildCap(topRadius, height / 2, true); // Top cap at height / 2 along y-axis
-
-        if (baseRadius > 0.0f)
-            buildCap(baseRadius, -height / 2, false); // Bottom cap at -height / 2 along y-axis
-    }
-    void buildVertices()
+    static void buildMesh(const MeshKey& key, vector<float>& vertices, vector<unsigned int>& indices)
     {
-        size_t count = coordinates.size();
-        for (size_t i = 0; i < count; i += 3)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+        int caps = Geometry::capCount(key.radius, key.topRadius);
+        vertices.resize((size_t)Geometry::vertexCount(key.sectorCount, key.stackCount, caps) * 6);
+        indices.resize(Geometry::indexCount(key.sectorCount, key.stackCount, caps));
+        SurfaceOfRevolution<UprightLayout> surface(key.sectorCount, 2 * PI, vertices.data(), indices.data());
+        Geometry::generate(surface, key.radius, key.topRadius, key.height, key.stackCount);
     }
 
-    void buildCap(float radius, float y, bool isTop)
+    static MeshKey defaultKey()
     {
-        float sectorStep = 2 * PI / sectorCount;
-        float sectorAngle;
-
-        int centerIndex = coordinates.size() / 3; // Index of the center vertex
-        coordinates.push_back(0.0f);
-        coordinates.push_back(y); // Cap center along y-axis
-        coordinates.push_back(0.0f);
+        return meshKey(DEFAULT_CYL_BASE_RADIUS, DEFAULT_CYL_TOP_RADIUS, DEFAULT_CYL_HEIGHT, DEFAULT_CYL_SECTOR_COUNT, DEFAULT_CYL_STACK_COUNT);
+    }
 
-        normals.push_back(0.0f);
-        normals.push_back(isTop ? 1.0f : -1.0f); // Normal along y-axis
-        normals.push_back(0.0f);
+    static constexpr int DEFAULT_CAPS = Geometry::capCount(DEFAULT_CYL_BASE_RADIUS, DEFAULT_CYL_TOP_RADIUS);
+    typedef GeometryTable<Geometry::vertexCount(DEFAULT_CYL_SECTOR_COUNT, DEFAULT_CYL_STACK_COUNT, DEFAULT_CAPS),
+        Geometry::indexCount(DEFAULT_CYL_SECTOR_COUNT, DEFAULT_CYL_STACK_COUNT, DEFAULT_CAPS)> DefaultTable;
 
-        for (int j = 0; j <= sectorCount; ++j)
-        {
-            sectorAngle = j * sectorStep;
-            float x = radius * cosf(sectorAngle);
-            float z = radius * sinf(sectorAngle);
-
-            coordinates.push_back(x);
-            coordinates.push_back(y); // Points on cap along y-axis
-            coordinates.push_back(z);
-
-            normals.push_back(0.0f);
-            normals.push_back(isTop ? 1.0f : -1.0f); // Normal along y-axis
-            normals.push_back(0.0f);
-
-            if (j < sectorCount)
-            {
-                if (isTop)
-                {
-                    indices.push_back(centerIndex);
-                    indices.push_back(centerIndex + j + 1);
-                    indices.push_back(centerIndex + j + 2);
-                }
-                else
-                {
-                    indices.push_back(centerIndex);
-                    indices.push_back(centerIndex + j + 2);
-                    indices.push_back(centerIndex + j + 1);
-                }
-            }
-        }
+    static const DefaultTable& defaultTable()
+    {
+        static constexpr DefaultTable table = makeGeometryTable<Geometry, DefaultTable>(
+            DEFAULT_CYL_SECTOR_COUNT, 2 * PI, DEFAULT_CYL_BASE_RADIUS, DEFAULT_CYL_TOP_RADIUS, DEFAULT_CYL_HEIGHT, DEFAULT_CYL_STACK_COUNT);
+        return table;
     }
 
-    unsigned int cylinderVAO;
     float baseRadius, topRadius, height;
     int sectorCount, stackCount;
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    int verticesStride; // Bytes between consecutive vertices
 };
 
 #endif /* cylinder_h */
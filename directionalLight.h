@@ -9,7 +9,7 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "shader.h"
+#include "lightBlock.h"
 
 class DirectionalLight {
 public:
@@ -30,19 +30,14 @@ public:
         direction = glm::vec3(dirx, diry, dirz);
 
     }
-    void setUpDirectionalLight(Shader& lightingShader)
+    void setUpDirectionalLight(LightBlock& lights) const
     {
-        lightingShader.use();
-
-
-        
-        lightingShader.setVec3("diectionalLight.ambient", ambientOn * ambient);
-        lightingShader.setVec3("diectionalLight.diffuse", diffuseOn * diffuse);
-        lightingShader.setVec3("diectionalLight.specular", specularOn * specular);
-        lightingShader.setVec3("diectionalLight.direction", direction);
-        
-        
-        
+        DirectionalLightUniform light = {};
+        light.ambient = ambientOn * ambient;
+        light.diffuse = diffuseOn * diffuse;
+        light.specular = specularOn * specular;
+        light.direction = direction;
+        lights.setDirectionalLight(light);
     }
     void turnOff()
     {
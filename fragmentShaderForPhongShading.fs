@@ -10,56 +10,62 @@ struct Material {
 };
 
 
+// light structs of the Lights block; each vec3 is followed by a float so that std140
+// packs the two into one 16 byte slot, matching the C++ structs in uniformBlocks.h
 struct DiectionalLight {
-    
-    
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
     vec3 direction;
-
 };
 
 struct PointLight {
     vec3 position;
-    
     float k_c;  // attenuation factors
-    float k_l;  // attenuation factors
-    float k_q;  // attenuation factors
-    
     vec3 ambient;
+    float k_l;  // attenuation factors
     vec3 diffuse;
+    float k_q;  // attenuation factors
     vec3 specular;
 };
 
 struct SpotLight {
     vec3 position;
-    vec3 direction;
-
     float cos_theta;
-    
+    vec3 direction;
     float k_c;  // attenuation factors
-    float k_l;  // attenuation factors
-    float k_q;  // attenuation factors
-    
     vec3 ambient;
+    float k_l;  // attenuation factors
     vec3 diffuse;
+    float k_q;  // attenuation factors
     vec3 specular;
 };
 
-
-
-
-#define NR_POINT_LIGHTS 2
+#define MAX_POINT_LIGHTS 4
 
 in vec3 FragPos;
 in vec3 Normal;
-
-uniform vec3 viewPos;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
-uniform Material material;
-uniform DiectionalLight diectionalLight;
+// the draw's entry of the Materials block, fetched by the vertex shader
+flat in vec3 MaterialAmbient;
+flat in vec3 MaterialDiffuse;
+flat in vec4 MaterialSpecular;
+flat in vec3 MaterialEmissive;
+
+// same block as the vertex shader, only viewPos is read here
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+// every light of the scene, shared by all lighting programs and updated only when a light changes
+layout (std140) uniform Lights
+{
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    SpotLight spotLight;
+    DiectionalLight diectionalLight;
+    int pointLightCount;
+};
 uniform bool dlighton = true;
 //uniform bool spotlighton = true;
 
@@ -77,15 +83,17 @@ void main()
     // properties
     vec3 N = normalize(Normal);
     vec3 V = normalize(viewPos - FragPos);
+
+    Material m = Material(MaterialAmbient, MaterialDiffuse, MaterialSpecular.rgb, MaterialEmissive, MaterialSpecular.a);
     
     vec3 result;
     // point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(material, pointLights[i], N, FragPos, V);
+    for(int i = 0; i < pointLightCount; i++)
+        result += CalcPointLight(m, pointLights[i], N, FragPos, V);
     
-    result += CalcDirectionalLight(material, diectionalLight, N, V);
-    result += CalcSpotLight(material, spotLight, N, FragPos, V);
-    result += material.emissive;
+    result += CalcDirectionalLight(m, diectionalLight, N, V);
+    result += CalcSpotLight(m, spotLight, N, FragPos, V);
+    result += m.emissive;
     FragColor = vec4(result, 1.0);
 }
 
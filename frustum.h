@@ -0,0 +1,194 @@
+//
+//  frustum.h
+//  object space bounding volumes and view frustum culling against the planes
+//  of projection * view; set once per frame before drawing, like LodContext
+//
+
+#ifndef frustum_h
+#define frustum_h
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+// axis aligned box and sphere around the same geometry, in its own space
+struct Bounds
+{
+    glm::vec3 boxMin = glm::vec3(0.0f);
+    glm::vec3 boxMax = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f);     // of the sphere, the middle of the box
+    float radius = 0.0f;
+
+    static Bounds fromBox(const glm::vec3& boxMin, const glm::vec3& boxMax)
+    {
+        Bounds bounds;
+        bounds.boxMin = boxMin;
+        bounds.boxMax = boxMax;
+        bounds.center = (boxMin + boxMax) * 0.5f;
+        bounds.radius = glm::length(boxMax - boxMin) * 0.5f;
+        return bounds;
+    }
+};
+
+// grows a box point by point; empty until the first point
+struct BoundsBuilder
+{
+    glm::vec3 boxMin = glm::vec3(numeric_limits<float>::max());
+    glm::vec3 boxMax = glm::vec3(-numeric_limits<float>::max());
+
+    void add(float x, float y, float z)
+    {
+        boxMin = glm::vec3(fminf(boxMin.x, x), fminf(boxMin.y, y), fminf(boxMin.z, z));
+        boxMax = glm::vec3(fmaxf(boxMax.x, x), fmaxf(boxMax.y, y), fmaxf(boxMax.z, z));
+    }
+
+    bool empty() const { return boxMin.x > boxMax.x; }
+
+    Bounds build() const
+    {
+        return empty() ? Bounds() : Bounds::fromBox(boxMin, boxMax);
+    }
+};
+
+// six planes, normals pointing inside, normalized so plane distances are in world units
+class Frustum
+{
+public:
+    Frustum() {}
+
+    // Gribb and Hartmann: each plane is the last row of the matrix plus or minus another row
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        const glm::vec4 rows[4] = {
+            row(viewProjection, 0), row(viewProjection, 1), row(viewProjection, 2), row(viewProjection, 3)
+        };
+        planes[0] = rows[3] + rows[0];      // left
+        planes[1] = rows[3] - rows[0];      // right
+        planes[2] = rows[3] + rows[1];      // bottom
+        planes[3] = rows[3] - rows[1];      // top
+        planes[4] = rows[3] + rows[2];      // near
+        planes[5] = rows[3] - rows[2];      // far
+        for (glm::vec4& plane : planes)
+        {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f)
+                plane = plane * (1.0f / length);
+        }
+    }
+
+    // bounds transformed by model; the sphere decides most objects, the box the rest
+    bool intersects(const Bounds& bounds, const glm::mat4& model) const
+    {
+        const glm::vec3 center = glm::vec3(model * glm::vec4(bounds.center, 1.0f));
+        float scale = glm::length(glm::vec3(model[0]));
+        scale = fmaxf(scale, glm::length(glm::vec3(model[1])));
+        scale = fmaxf(scale, glm::length(glm::vec3(model[2])));
+        const float radius = bounds.radius * scale;
+
+        bool inside = true;
+        for (const glm::vec4& plane : planes)
+        {
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            if (distance < -radius)
+                return false;
+            if (distance < radius)
+                inside = false;
+        }
+        if (inside)
+            return true;
+
+        // the box in world space: same center, extents through the absolute basis
+        const glm::vec3 extents = (bounds.boxMax - bounds.boxMin) * 0.5f;
+        const glm::vec3 worldExtents =
+            glm::abs(glm::vec3(model[0])) * extents.x +
+            glm::abs(glm::vec3(model[1])) * extents.y +
+            glm::abs(glm::vec3(model[2])) * extents.z;
+        for (const glm::vec4& plane : planes)
+        {
+            float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            if (distance < -glm::dot(glm::abs(glm::vec3(plane)), worldExtents))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static glm::vec4 row(const glm::mat4& m, int i)
+    {
+        return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+
+    glm::vec4 planes[6];
+};
+
+// objects tested since the frame was set
+struct CullStats
+{
+    unsigned int visible = 0;
+    unsigned int culled = 0;
+
+    unsigned int tested() const { return visible + culled; }
+};
+
+// camera of the current frame; set once per frame before drawing
+class FrustumCulling
+{
+public:
+    static void setFrame(const glm::mat4& viewProjection)
+    {
+        Frame& frame = current();
+        frame.lastStats = frame.stats;
+        frame.stats = CullStats();
+        frame.frustum = Frustum(viewProjection);
+        frame.valid = true;
+    }
+
+    // stop culling, everything is visible
+    static void clearFrame()
+    {
+        current().valid = false;
+    }
+
+    static bool hasFrame()
+    {
+        return current().valid;
+    }
+
+    // whether anything of bounds under model may be on screen; counted in the frame's stats
+    static bool isVisible(const Bounds& bounds, const glm::mat4& model)
+    {
+        Frame& frame = current();
+        if (!frame.valid)
+            return true;
+        bool visible = frame.frustum.intersects(bounds, model);
+        if (visible)
+            ++frame.stats.visible;
+        else
+            ++frame.stats.culled;
+        return visible;
+    }
+
+    // counts of the frame in progress, and of the one before it
+    static const CullStats& getStats() { return current().stats; }
+    static const CullStats& getLastFrameStats() { return current().lastStats; }
+
+private:
+    struct Frame
+    {
+        Frustum frustum;
+        CullStats stats;
+        CullStats lastStats;
+        bool valid = false;
+    };
+
+    static Frame& current()
+    {
+        static Frame frame;
+        return frame;
+    }
+};
+
+#endif /* frustum_h */
@@ -0,0 +1,292 @@
+//
+//  geometryPool.h
+//  one vertex buffer, one index buffer and one VAO shared by every mesh of a vertex format
+//
+
+#ifndef geometryPool_h
+#define geometryPool_h
+
+#include <glad/glad.h>
+#include <vector>
+#include "vertexFormat.h"
+#include "glState.h"
+
+using namespace std;
+
+// first fit allocator over [0, capacity); freed ranges are merged with their neighbours
+class FreeListAllocator
+{
+public:
+    static const size_t INVALID = (size_t)-1;
+
+    explicit FreeListAllocator(size_t capacity = 0) : capacity(0)
+    {
+        grow(capacity);
+    }
+
+    // offset of a range of size units starting on a multiple of alignment, or INVALID
+    size_t allocate(size_t size, size_t alignment = 1)
+    {
+        for (size_t i = 0; i < blocks.size(); ++i)
+        {
+            Block block = blocks[i];
+            size_t start = (block.offset + alignment - 1) / alignment * alignment;
+            if (start + size > block.offset + block.size)
+                continue;
+
+            // keep what is left on either side of the allocation
+            size_t end = start + size;
+            size_t blockEnd = block.offset + block.size;
+            blocks.erase(blocks.begin() + i);
+            if (blockEnd > end)
+                blocks.insert(blocks.begin() + i, Block{ end, blockEnd - end });
+            if (start > block.offset)
+                blocks.insert(blocks.begin() + i, Block{ block.offset, start - block.offset });
+            used += size;
+            return start;
+        }
+        return INVALID;
+    }
+
+    void free(size_t offset, size_t size)
+    {
+        size_t i = 0;
+        while (i < blocks.size() && blocks[i].offset < offset)
+            ++i;
+        blocks.insert(blocks.begin() + i, Block{ offset, size });
+        used -= size;
+
+        // merge with the following and the preceding block
+        if (i + 1 < blocks.size() && blocks[i].offset + blocks[i].size == blocks[i + 1].offset)
+        {
+            blocks[i].size += blocks[i + 1].size;
+            blocks.erase(blocks.begin() + i + 1);
+        }
+        if (i > 0 && blocks[i - 1].offset + blocks[i - 1].size == blocks[i].offset)
+        {
+            blocks[i - 1].size += blocks[i].size;
+            blocks.erase(blocks.begin() + i);
+        }
+    }
+
+    // extends the range, the new space is free
+    void grow(size_t newCapacity)
+    {
+        if (newCapacity <= capacity)
+            return;
+        size_t added = newCapacity - capacity;
+        if (!blocks.empty() && blocks.back().offset + blocks.back().size == capacity)
+            blocks.back().size += added;
+        else
+            blocks.push_back(Block{ capacity, added });
+        capacity = newCapacity;
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    size_t getFreeBlockCount() const { return blocks.size(); }
+
+private:
+    struct Block
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    vector<Block> blocks;                   // free ranges, sorted by offset
+    size_t capacity;
+    size_t used = 0;
+};
+
+// a sub-allocated mesh: where its vertices and indices live inside the pool
+struct PoolAllocation
+{
+    GLint baseVertex = 0;                   // first vertex, added to every index by the draw
+    unsigned int vertexCount = 0;
+    size_t indexOffset = 0;                 // in bytes
+    size_t indexBytes = 0;
+};
+
+class GeometryPool
+{
+public:
+    // the shared pool of a vertex format, created on first use (needs a current GL context)
+    static GeometryPool& forFormat(VertexFormat format)
+    {
+        GeometryPool*& pool = pools()[format];
+        if (pool == nullptr)
+            pool = new GeometryPool(format);
+        return *pool;
+    }
+
+    // delete the GL objects of every pool, call while the GL context is still current
+    static void releaseAll()
+    {
+        GeometryPool** all = pools();
+        for (int format = 0; format < FORMAT_COUNT; ++format)
+        {
+            delete all[format];
+            all[format] = nullptr;
+        }
+    }
+
+    // binds the pool's VAO unless it already is
+    void bind() const
+    {
+        GLState::bindVertexArray(VAO);
+    }
+
+    // copies the vertices (already in the pool's format) and indices into free ranges
+    PoolAllocation allocate(const void* vertices, unsigned int vertexCount, const void* indices, size_t indexBytes)
+    {
+        PoolAllocation allocation;
+        allocation.vertexCount = vertexCount;
+        allocation.indexBytes = indexBytes;
+
+        size_t baseVertex = vertexSpace.allocate(vertexCount);
+        if (baseVertex == FreeListAllocator::INVALID)
+        {
+            growVertices(vertexSpace.getCapacity() + vertexCount);
+            baseVertex = vertexSpace.allocate(vertexCount);
+        }
+        // 4 byte aligned so 16 and 32-bit index ranges can share the buffer
+        size_t indexOffset = indexSpace.allocate(indexBytes, 4);
+        if (indexOffset == FreeListAllocator::INVALID)
+        {
+            growIndices(indexSpace.getCapacity() + indexBytes + 4);
+            indexOffset = indexSpace.allocate(indexBytes, 4);
+        }
+        allocation.baseVertex = (GLint)baseVertex;
+        allocation.indexOffset = indexOffset;
+
+        // through the copy target, so no VAO's element array binding is touched
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, baseVertex * stride, (GLsizeiptr)vertexCount * stride, vertices);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes, indices);
+        return allocation;
+    }
+
+    void free(const PoolAllocation& allocation)
+    {
+        vertexSpace.free(allocation.baseVertex, allocation.vertexCount);
+        indexSpace.free(allocation.indexOffset, allocation.indexBytes);
+    }
+
+    unsigned int getVAO() const { return VAO; }
+    unsigned int getVBO() const { return VBO; }
+    unsigned int getEBO() const { return EBO; }
+    int getStride() const { return stride; }
+    VertexFormat getFormat() const { return format; }
+
+    // memory accounting, in bytes
+    size_t getCapacityBytes() const { return vertexSpace.getCapacity() * stride + indexSpace.getCapacity(); }
+    size_t getUsedBytes() const { return vertexSpace.getUsed() * stride + indexSpace.getUsed(); }
+
+private:
+    static const int FORMAT_COUNT = 2;     // VERTEX_FLOAT, VERTEX_COMPACT
+    static const size_t INITIAL_VERTICES = 1 << 16;
+    static const size_t INITIAL_INDEX_BYTES = 1 << 18;
+
+    explicit GeometryPool(VertexFormat format)
+        : format(format), stride(format == VERTEX_COMPACT ? COMPACT_VERTEX_STRIDE : 24)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        resizeBuffer(VBO, 0, INITIAL_VERTICES * stride);
+        resizeBuffer(EBO, 0, INITIAL_INDEX_BYTES);
+        vertexSpace.grow(INITIAL_VERTICES);
+        indexSpace.grow(INITIAL_INDEX_BYTES);
+        setupVertexArray();
+    }
+
+    ~GeometryPool()
+    {
+        GLState::forgetVertexArray(VAO);
+        GLState::forgetBuffer(VBO);
+        GLState::forgetBuffer(EBO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    void setupVertexArray()
+    {
+        GLState::bindVertexArray(VAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // position and normal, interleaved
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        if (format == VERTEX_COMPACT)
+        {
+            glVertexAttribPointer(0, 3, GL_HALF_FLOAT, false, stride, (void*)0);
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, true, stride, (void*)COMPACT_NORMAL_OFFSET);
+        }
+        else
+        {
+            glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
+        }
+    }
+
+    // reallocates buffer with newBytes, keeping the first usedBytes
+    static void resizeBuffer(GLuint& buffer, size_t usedBytes, size_t newBytes)
+    {
+        GLuint resized;
+        glGenBuffers(1, &resized);
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, resized);
+        glBufferData(GL_COPY_WRITE_BUFFER, newBytes, nullptr, GL_STATIC_DRAW);
+        if (usedBytes > 0)
+        {
+            GLState::bindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+        }
+        if (buffer != 0)
+        {
+            GLState::forgetBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = resized;
+    }
+
+    // at least doubles, existing allocations keep their offsets
+    void growVertices(size_t minimum)
+    {
+        size_t capacity = vertexSpace.getCapacity();
+        size_t grown = capacity * 2 > minimum ? capacity * 2 : minimum;
+        resizeBuffer(VBO, capacity * stride, grown * stride);
+        vertexSpace.grow(grown);
+        setupVertexArray();
+    }
+
+    void growIndices(size_t minimum)
+    {
+        size_t capacity = indexSpace.getCapacity();
+        size_t grown = capacity * 2 > minimum ? capacity * 2 : minimum;
+        resizeBuffer(EBO, capacity, grown);
+        indexSpace.grow(grown);
+        setupVertexArray();
+    }
+
+    static GeometryPool** pools()
+    {
+        static GeometryPool* all[FORMAT_COUNT] = { nullptr, nullptr };
+        return all;
+    }
+
+    VertexFormat format;
+    int stride;
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    FreeListAllocator vertexSpace;          // in vertices
+    FreeListAllocator indexSpace;           // in bytes
+};
+
+#endif /* geometryPool_h */
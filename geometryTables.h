@@ -0,0 +1,217 @@
+//
+//  geometryTables.h
+//  vertex and index tables generated at compile time (unit cube, default primitives)
+//
+
+#ifndef geometryTables_h
+#define geometryTables_h
+
+#include "parametricSurface.h"
+#include "meshOptimizer.h"
+
+// sin/cos usable in constant expressions: range reduction plus a Taylor series,
+// accurate to well below float precision
+constexpr double constexprSin(double x)
+{
+    const double pi = 3.14159265358979323846;
+    while (x > pi)
+        x -= 2 * pi;
+    while (x < -pi)
+        x += 2 * pi;
+
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexprCos(double x)
+{
+    return constexprSin(x + 3.14159265358979323846 / 2);
+}
+
+// interleaved position + normal vertices and their indices, as plain arrays
+template <unsigned int VertexCount, unsigned int IndexCount>
+struct GeometryTable
+{
+    static constexpr unsigned int vertexCount = VertexCount;
+    static constexpr unsigned int indexCount = IndexCount;
+
+    constexpr GeometryTable() : vertices(), indices(), unoptimized(), optimized() {}
+
+    float vertices[VertexCount * 6];
+    unsigned int indices[IndexCount];
+    VertexCacheStats unoptimized;           // as generated
+    VertexCacheStats optimized;             // after optimizeGeometryTable()
+};
+
+template <unsigned int VertexCount, unsigned int IndexCount>
+constexpr unsigned int GeometryTable<VertexCount, IndexCount>::vertexCount;
+
+template <unsigned int VertexCount, unsigned int IndexCount>
+constexpr unsigned int GeometryTable<VertexCount, IndexCount>::indexCount;
+
+// same interface as SurfaceOfRevolution, evaluated by the compiler; the shape recipes
+// are templates over the surface so both produce the same topology
+template <typename Layout>
+class ConstexprSurface : public SurfaceTopology
+{
+public:
+    constexpr ConstexprSurface(int sectorCount, float fullAngle, float* vertices, unsigned int* indices)
+        : sectorCount(sectorCount), sectorStep(fullAngle / sectorCount), vertices(vertices), indices(indices)
+    {
+    }
+
+    static constexpr float sine(float angle) { return (float)constexprSin(angle); }
+    static constexpr float cosine(float angle) { return (float)constexprCos(angle); }
+
+    constexpr unsigned int ring(float radius, float axial, float normalRadial, float normalAxial)
+    {
+        unsigned int first = vertexCount;
+        for (int j = 0; j <= sectorCount; ++j)
+        {
+            float s = sine(j * sectorStep);
+            float c = cosine(j * sectorStep);
+            float* v = vertices + (vertexCount + j) * 6;
+            v[Layout::sinComponent] = radius * s;
+            v[Layout::cosComponent] = radius * c;
+            v[Layout::axisComponent] = axial;
+            v[3 + Layout::sinComponent] = normalRadial * s;
+            v[3 + Layout::cosComponent] = normalRadial * c;
+            v[3 + Layout::axisComponent] = normalAxial;
+        }
+        vertexCount += sectorCount + 1;
+        return first;
+    }
+
+    constexpr unsigned int point(float axial, float normalAxial)
+    {
+        float* v = vertices + vertexCount * 6;
+        v[0] = v[1] = v[2] = v[3] = v[4] = v[5] = 0.0f;
+        v[Layout::axisComponent] = axial;
+        v[3 + Layout::axisComponent] = normalAxial;
+        return vertexCount++;
+    }
+
+    constexpr void strip(unsigned int firstRing, int bandCount, bool poleAtFirst, bool poleAtLast)
+    {
+        const unsigned int ringSize = sectorCount + 1;
+        for (int i = 0; i < bandCount; ++i)
+        {
+            unsigned int k1 = firstRing + i * ringSize;
+            unsigned int k2 = k1 + ringSize;
+            bool topPole = poleAtFirst && i == 0;
+            bool bottomPole = poleAtLast && i == bandCount - 1 && !topPole;
+            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+            {
+                if (!topPole)
+                    emit(k1, k2, k1 + 1);
+                if (!bottomPole)
+                    emit(k1 + 1, k2, k2 + 1);
+            }
+        }
+    }
+
+    constexpr void fan(unsigned int center, unsigned int ringStart, bool reversed)
+    {
+        for (int j = 0; j < sectorCount; ++j)
+        {
+            if (reversed)
+                emit(center, ringStart + j + 1, ringStart + j);
+            else
+                emit(center, ringStart + j, ringStart + j + 1);
+        }
+    }
+
+    constexpr unsigned int getVertexCount() const { return vertexCount; }
+    constexpr unsigned int getIndexCount() const { return indexCount; }
+
+private:
+    constexpr void emit(unsigned int a, unsigned int b, unsigned int c)
+    {
+        indices[indexCount++] = a;
+        indices[indexCount++] = b;
+        indices[indexCount++] = c;
+    }
+
+    int sectorCount;
+    float sectorStep;
+    float* vertices;
+    unsigned int* indices;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+};
+
+// vertex cache and fetch optimization of a table, the same passes the runtime
+// generated meshes go through
+template <unsigned int VertexCount, unsigned int IndexCount>
+constexpr void optimizeGeometryTable(GeometryTable<VertexCount, IndexCount>& table)
+{
+    struct Scratch
+    {
+        constexpr Scratch() : data(), vertices(), indices() {}
+
+        unsigned int data[meshOptimizerScratchSize(IndexCount, VertexCount)];
+        float vertices[VertexCount * 6];
+        unsigned int indices[IndexCount];
+    };
+
+    Scratch scratch;
+    optimizeMeshBuffers(table.vertices, table.indices, VertexCount, IndexCount, 6,
+        scratch.data, scratch.vertices, scratch.indices, table.unoptimized, table.optimized);
+}
+
+// runs a shape recipe (see SphereGeometry and friends) at compile time
+template <typename Geometry, typename Table, typename... Args>
+constexpr Table makeGeometryTable(int sectorCount, float fullAngle, Args... args)
+{
+    Table table;
+    ConstexprSurface<typename Geometry::Layout> surface(sectorCount, fullAngle, table.vertices, table.indices);
+    Geometry::generate(surface, args...);
+    optimizeGeometryTable(table);
+    return table;
+}
+
+// axis aligned cube with one corner at the origin, 4 vertices per face so every
+// face keeps its own flat normal
+constexpr GeometryTable<24, 36> makeCubeTable(float size)
+{
+    GeometryTable<24, 36> table;
+    const float cornerU[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+    const float cornerV[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    for (int face = 0; face < 6; ++face)
+    {
+        int axis = face / 2;
+        bool positive = face % 2 == 0;
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        unsigned int first = face * 4;
+
+        // counter-clockwise seen from outside the cube
+        for (int k = 0; k < 4; ++k)
+        {
+            int corner = positive ? k : 3 - k;
+            float* out = table.vertices + (first + k) * 6;
+            out[axis] = positive ? size : 0.0f;
+            out[u] = cornerU[corner] * size;
+            out[v] = cornerV[corner] * size;
+            out[3 + axis] = positive ? 1.0f : -1.0f;
+        }
+
+        unsigned int* index = table.indices + face * 6;
+        index[0] = first;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 3;
+        index[5] = first;
+    }
+    return table;
+}
+
+#endif /* geometryTables_h */
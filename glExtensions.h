@@ -0,0 +1,168 @@
+//
+//  glExtensions.h
+//  GL 4.x entry points the 3.3 core loader does not provide, loaded by hand and
+//  used only when the context actually supports them
+//
+
+#ifndef glExtensions_h
+#define glExtensions_h
+
+#include <glad/glad.h>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT 0x90DF
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC_EXT)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1IPROC_EXT)(GLuint program, GLint location, GLint v0);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORM1FPROC_EXT)(GLuint program, GLint location, GLfloat v0);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMFVPROC_EXT)(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+typedef void (APIENTRYP PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT)(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+// one draw of glMultiDrawElementsIndirect, as the GL reads it from the indirect buffer
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;                      // in indices, not bytes
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+class GLExtensions
+{
+public:
+    // call once after gladLoadGLLoader(), with the same loader
+    static void load(GLADloadproc loader)
+    {
+        Functions& f = functions();
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        f.version = major * 10 + minor;
+
+        if (f.version >= 44 || hasExtension("GL_ARB_buffer_storage"))
+            f.bufferStorage = (PFNGLBUFFERSTORAGEPROC_EXT)loader("glBufferStorage");
+
+        // the indirect shaders are GLSL 430 and index the per-draw storage buffer with
+        // gl_DrawIDARB, so the extensions alone on an older context are not enough
+        if (f.version >= 43 && hasExtension("GL_ARB_shader_draw_parameters"))
+            f.multiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT)loader("glMultiDrawElementsIndirect");
+
+        // uniforms written straight into a program, without binding it
+        if (f.version >= 41 || hasExtension("GL_ARB_separate_shader_objects"))
+        {
+            f.programUniform1i = (PFNGLPROGRAMUNIFORM1IPROC_EXT)loader("glProgramUniform1i");
+            f.programUniform1f = (PFNGLPROGRAMUNIFORM1FPROC_EXT)loader("glProgramUniform1f");
+            f.programUniform2fv = (PFNGLPROGRAMUNIFORMFVPROC_EXT)loader("glProgramUniform2fv");
+            f.programUniform3fv = (PFNGLPROGRAMUNIFORMFVPROC_EXT)loader("glProgramUniform3fv");
+            f.programUniform4fv = (PFNGLPROGRAMUNIFORMFVPROC_EXT)loader("glProgramUniform4fv");
+            f.programUniformMatrix2fv = (PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT)loader("glProgramUniformMatrix2fv");
+            f.programUniformMatrix3fv = (PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT)loader("glProgramUniformMatrix3fv");
+            f.programUniformMatrix4fv = (PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT)loader("glProgramUniformMatrix4fv");
+            f.hasProgramUniform = f.programUniform1i != nullptr && f.programUniform1f != nullptr
+                && f.programUniform2fv != nullptr && f.programUniform3fv != nullptr && f.programUniform4fv != nullptr
+                && f.programUniformMatrix2fv != nullptr && f.programUniformMatrix3fv != nullptr && f.programUniformMatrix4fv != nullptr;
+        }
+    }
+
+    static bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension != nullptr && strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // major * 10 + minor of the current context, 0 before load()
+    static int version() { return functions().version; }
+
+    // immutable storage, needed for persistently mapped buffers
+    static bool hasBufferStorage() { return functions().bufferStorage != nullptr; }
+    static void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+    {
+        functions().bufferStorage(target, size, data, flags);
+    }
+
+    // multi-draw indirect, storage buffers and gl_DrawIDARB, all three or none
+    static bool hasMultiDrawIndirect() { return functions().multiDrawElementsIndirect != nullptr; }
+    static void multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride)
+    {
+        functions().multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+
+    // glProgramUniform*, every variant Shader uses or none
+    static bool hasProgramUniform() { return functions().hasProgramUniform; }
+    static void programUniform1i(GLuint program, GLint location, GLint v0) { functions().programUniform1i(program, location, v0); }
+    static void programUniform1f(GLuint program, GLint location, GLfloat v0) { functions().programUniform1f(program, location, v0); }
+    static void programUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        functions().programUniform2fv(program, location, count, value);
+    }
+    static void programUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        functions().programUniform3fv(program, location, count, value);
+    }
+    static void programUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        functions().programUniform4fv(program, location, count, value);
+    }
+    static void programUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        functions().programUniformMatrix2fv(program, location, count, transpose, value);
+    }
+    static void programUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        functions().programUniformMatrix3fv(program, location, count, transpose, value);
+    }
+    static void programUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        functions().programUniformMatrix4fv(program, location, count, transpose, value);
+    }
+
+private:
+    // the tracer swaps its own wrappers into these
+    friend class GLTrace;
+
+    struct Functions
+    {
+        int version = 0;
+        PFNGLBUFFERSTORAGEPROC_EXT bufferStorage = nullptr;
+        PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT multiDrawElementsIndirect = nullptr;
+        bool hasProgramUniform = false;
+        PFNGLPROGRAMUNIFORM1IPROC_EXT programUniform1i = nullptr;
+        PFNGLPROGRAMUNIFORM1FPROC_EXT programUniform1f = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform2fv = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform3fv = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform4fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix2fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix3fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix4fv = nullptr;
+    };
+
+    static Functions& functions()
+    {
+        static Functions loaded;
+        return loaded;
+    }
+};
+
+#endif /* glExtensions_h */
@@ -0,0 +1,213 @@
+//
+//  glState.h
+//  shadow copy of the bound program, vertex array, buffers, blend and depth
+//  state; a bind that would not change anything never reaches the driver
+//
+
+#ifndef glState_h
+#define glState_h
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <unordered_map>
+#include "glExtensions.h"
+
+using namespace std;
+
+// a binding the cache has not seen yet, or lost track of
+const GLuint GL_STATE_UNKNOWN = 0xFFFFFFFFu;
+
+class GLState
+{
+public:
+    static void useProgram(GLuint program)
+    {
+        State& s = state();
+        if (s.program == program)
+            return;
+        glUseProgram(program);
+        s.program = program;
+    }
+
+    static void bindVertexArray(GLuint vao)
+    {
+        State& s = state();
+        if (s.vao == vao)
+            return;
+        glBindVertexArray(vao);
+        s.vao = vao;
+        // the element buffer binding is part of the vertex array
+        s.buffers[slot(GL_ELEMENT_ARRAY_BUFFER)] = GL_STATE_UNKNOWN;
+    }
+
+    static void bindBuffer(GLenum target, GLuint buffer)
+    {
+        int index = slot(target);
+        if (index < 0)
+        {
+            glBindBuffer(target, buffer);
+            return;
+        }
+        GLuint& bound = state().buffers[index];
+        if (bound == buffer)
+            return;
+        glBindBuffer(target, buffer);
+        bound = buffer;
+    }
+
+    // indexed uniform or storage block bindings; both also bind the generic target
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        bindBufferRange(target, index, buffer, 0, -1);
+    }
+
+    // size -1 is the whole buffer
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        State& s = state();
+        IndexedBinding& bound = s.indexedBuffers[((uint64_t)target << 32) | index];
+        if (bound.buffer == buffer && bound.offset == offset && bound.size == size)
+            return;
+        if (size < 0)
+            glBindBufferBase(target, index, buffer);
+        else
+            glBindBufferRange(target, index, buffer, offset, size);
+        bound.buffer = buffer;
+        bound.offset = offset;
+        bound.size = size;
+        int generic = slot(target);
+        if (generic >= 0)
+            s.buffers[generic] = buffer;
+    }
+
+    static void setBlend(bool enabled)
+    {
+        setCapability(GL_BLEND, enabled, state().blend);
+    }
+
+    static void blendFunc(GLenum source, GLenum destination)
+    {
+        State& s = state();
+        if (s.blendSource == source && s.blendDestination == destination)
+            return;
+        glBlendFunc(source, destination);
+        s.blendSource = source;
+        s.blendDestination = destination;
+    }
+
+    static void setDepthTest(bool enabled)
+    {
+        setCapability(GL_DEPTH_TEST, enabled, state().depthTest);
+    }
+
+    static void setDepthMask(bool enabled)
+    {
+        State& s = state();
+        int value = enabled ? 1 : 0;
+        if (s.depthMask == value)
+            return;
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        s.depthMask = value;
+    }
+
+    static GLuint currentProgram() { return state().program; }
+    static GLuint currentVertexArray() { return state().vao; }
+
+    // call before glDelete*: the GL unbinds a deleted object and may hand its name out again
+    static void forgetVertexArray(GLuint vao)
+    {
+        State& s = state();
+        if (s.vao == vao)
+        {
+            s.vao = GL_STATE_UNKNOWN;
+            s.buffers[slot(GL_ELEMENT_ARRAY_BUFFER)] = GL_STATE_UNKNOWN;
+        }
+    }
+
+    static void forgetBuffer(GLuint buffer)
+    {
+        State& s = state();
+        for (GLuint& bound : s.buffers)
+        {
+            if (bound == buffer)
+                bound = GL_STATE_UNKNOWN;
+        }
+        for (auto& indexed : s.indexedBuffers)
+        {
+            if (indexed.second.buffer == buffer)
+                indexed.second.buffer = GL_STATE_UNKNOWN;
+        }
+    }
+
+    // after GL calls that went around the cache, everything is bound again on next use
+    static void invalidate()
+    {
+        state() = State();
+    }
+
+private:
+    static const int BUFFER_SLOTS = 7;
+
+    struct IndexedBinding
+    {
+        GLuint buffer = GL_STATE_UNKNOWN;
+        GLintptr offset = 0;
+        GLsizeiptr size = 0;
+    };
+
+    struct State
+    {
+        State()
+        {
+            for (GLuint& bound : buffers)
+                bound = GL_STATE_UNKNOWN;
+        }
+
+        GLuint program = GL_STATE_UNKNOWN;
+        GLuint vao = GL_STATE_UNKNOWN;
+        GLuint buffers[BUFFER_SLOTS];
+        unordered_map<uint64_t, IndexedBinding> indexedBuffers;     // target << 32 | index
+        // -1 unknown, 0 off, 1 on
+        int blend = -1;
+        int depthTest = -1;
+        int depthMask = -1;
+        GLenum blendSource = 0;
+        GLenum blendDestination = 0;
+    };
+
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    // generic buffer targets the cache follows, -1 for the rest (bound every time)
+    static int slot(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_COPY_READ_BUFFER: return 2;
+        case GL_COPY_WRITE_BUFFER: return 3;
+        case GL_UNIFORM_BUFFER: return 4;
+        case GL_DRAW_INDIRECT_BUFFER: return 5;
+        case GL_SHADER_STORAGE_BUFFER: return 6;
+        default: return -1;
+        }
+    }
+
+    static void setCapability(GLenum capability, bool enabled, int& cached)
+    {
+        int value = enabled ? 1 : 0;
+        if (cached == value)
+            return;
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+        cached = value;
+    }
+};
+
+#endif /* glState_h */
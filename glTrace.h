@@ -0,0 +1,545 @@
+//
+//  glTrace.h
+//  opt-in debugging layer over the glad entry points: mirrors the bound state,
+//  counts each frame's calls and reports what the GL was asked to do twice
+//
+
+#ifndef glTrace_h
+#define glTrace_h
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "glExtensions.h"
+
+using namespace std;
+
+// how often the summary is printed, after the first frame
+const unsigned int GL_TRACE_REPORT_INTERVAL = 300;
+
+// counts of one frame; only the traced entry points below are seen
+struct GLTraceStats
+{
+    unsigned int draws = 0;
+    unsigned int duplicateDraws = 0;        // same draw again with nothing changed in between
+    unsigned int indirectDraws = 0;         // glMultiDrawElementsIndirect calls, also counted in draws
+    unsigned int programBinds = 0;
+    unsigned int redundantProgramBinds = 0;
+    unsigned int vaoBinds = 0;
+    unsigned int redundantVaoBinds = 0;
+    unsigned int bufferBinds = 0;
+    unsigned int redundantBufferBinds = 0;
+    unsigned int uniformWrites = 0;
+    unsigned int redundantUniformWrites = 0; // the program already held that value
+    unsigned int missingUniformWrites = 0;   // to location -1, the name is not in the program
+    unsigned int uniformLookups = 0;
+    unsigned int capabilityChanges = 0;
+    unsigned int redundantCapabilityChanges = 0;
+
+    unsigned int calls() const
+    {
+        return draws + programBinds + vaoBinds + bufferBinds + uniformWrites + uniformLookups + capabilityChanges;
+    }
+};
+
+class GLTrace
+{
+public:
+    // call once after gladLoadGLLoader() and GLExtensions::load(); every later call
+    // through glad or GLExtensions is traced
+    static void install()
+    {
+        Tracer& t = tracer();
+        if (t.installed)
+            return;
+        t.installed = true;
+        Real& r = t.real;
+
+        r.useProgram = glad_glUseProgram;                   glad_glUseProgram = useProgram;
+        r.bindVertexArray = glad_glBindVertexArray;         glad_glBindVertexArray = bindVertexArray;
+        r.bindBuffer = glad_glBindBuffer;                   glad_glBindBuffer = bindBuffer;
+        r.bindBufferBase = glad_glBindBufferBase;           glad_glBindBufferBase = bindBufferBase;
+        r.bindBufferRange = glad_glBindBufferRange;         glad_glBindBufferRange = bindBufferRange;
+        r.getUniformLocation = glad_glGetUniformLocation;   glad_glGetUniformLocation = getUniformLocation;
+        r.uniform1i = glad_glUniform1i;                     glad_glUniform1i = uniform1i;
+        r.uniform1f = glad_glUniform1f;                     glad_glUniform1f = uniform1f;
+        r.uniform2f = glad_glUniform2f;                     glad_glUniform2f = uniform2f;
+        r.uniform2fv = glad_glUniform2fv;                   glad_glUniform2fv = uniform2fv;
+        r.uniform3f = glad_glUniform3f;                     glad_glUniform3f = uniform3f;
+        r.uniform3fv = glad_glUniform3fv;                   glad_glUniform3fv = uniform3fv;
+        r.uniform4f = glad_glUniform4f;                     glad_glUniform4f = uniform4f;
+        r.uniform4fv = glad_glUniform4fv;                   glad_glUniform4fv = uniform4fv;
+        r.uniformMatrix2fv = glad_glUniformMatrix2fv;       glad_glUniformMatrix2fv = uniformMatrix2fv;
+        r.uniformMatrix3fv = glad_glUniformMatrix3fv;       glad_glUniformMatrix3fv = uniformMatrix3fv;
+        r.uniformMatrix4fv = glad_glUniformMatrix4fv;       glad_glUniformMatrix4fv = uniformMatrix4fv;
+        r.drawArrays = glad_glDrawArrays;                   glad_glDrawArrays = drawArrays;
+        r.drawElements = glad_glDrawElements;               glad_glDrawElements = drawElements;
+        r.drawElementsBaseVertex = glad_glDrawElementsBaseVertex;
+        glad_glDrawElementsBaseVertex = drawElementsBaseVertex;
+        r.drawElementsInstancedBaseVertex = glad_glDrawElementsInstancedBaseVertex;
+        glad_glDrawElementsInstancedBaseVertex = drawElementsInstancedBaseVertex;
+        r.enable = glad_glEnable;                           glad_glEnable = enable;
+        r.disable = glad_glDisable;                         glad_glDisable = disable;
+
+        // only the ones the context provides were loaded
+        GLExtensions::Functions& e = GLExtensions::functions();
+        if (e.multiDrawElementsIndirect != nullptr)
+        {
+            r.multiDrawElementsIndirect = e.multiDrawElementsIndirect;
+            e.multiDrawElementsIndirect = multiDrawElementsIndirect;
+        }
+        if (e.hasProgramUniform)
+        {
+            r.programUniform1i = e.programUniform1i;                e.programUniform1i = programUniform1i;
+            r.programUniform1f = e.programUniform1f;                e.programUniform1f = programUniform1f;
+            r.programUniform2fv = e.programUniform2fv;              e.programUniform2fv = programUniform2fv;
+            r.programUniform3fv = e.programUniform3fv;              e.programUniform3fv = programUniform3fv;
+            r.programUniform4fv = e.programUniform4fv;              e.programUniform4fv = programUniform4fv;
+            r.programUniformMatrix2fv = e.programUniformMatrix2fv;  e.programUniformMatrix2fv = programUniformMatrix2fv;
+            r.programUniformMatrix3fv = e.programUniformMatrix3fv;  e.programUniformMatrix3fv = programUniformMatrix3fv;
+            r.programUniformMatrix4fv = e.programUniformMatrix4fv;  e.programUniformMatrix4fv = programUniformMatrix4fv;
+        }
+
+        cout << "gl trace: installed, summary every " << GL_TRACE_REPORT_INTERVAL << " frames" << endl;
+    }
+
+    static bool isInstalled() { return tracer().installed; }
+
+    // both do nothing unless installed
+    static void beginFrame()
+    {
+        Tracer& t = tracer();
+        if (!t.installed)
+            return;
+        t.frame = GLTraceStats();
+        // a frame's first draw is never a duplicate of the last frame's
+        t.hasLastDraw = false;
+    }
+
+    static void endFrame()
+    {
+        Tracer& t = tracer();
+        if (!t.installed)
+            return;
+        t.lastFrame = t.frame;
+        ++t.frameCount;
+        if (t.frameCount == 1 || t.frameCount % GL_TRACE_REPORT_INTERVAL == 0)
+            report(t.frameCount, t.lastFrame);
+    }
+
+    // the last complete frame
+    static const GLTraceStats& getLastFrame() { return tracer().lastFrame; }
+
+private:
+    struct Real
+    {
+        PFNGLUSEPROGRAMPROC useProgram = nullptr;
+        PFNGLBINDVERTEXARRAYPROC bindVertexArray = nullptr;
+        PFNGLBINDBUFFERPROC bindBuffer = nullptr;
+        PFNGLBINDBUFFERBASEPROC bindBufferBase = nullptr;
+        PFNGLBINDBUFFERRANGEPROC bindBufferRange = nullptr;
+        PFNGLGETUNIFORMLOCATIONPROC getUniformLocation = nullptr;
+        PFNGLUNIFORM1IPROC uniform1i = nullptr;
+        PFNGLUNIFORM1FPROC uniform1f = nullptr;
+        PFNGLUNIFORM2FPROC uniform2f = nullptr;
+        PFNGLUNIFORM2FVPROC uniform2fv = nullptr;
+        PFNGLUNIFORM3FPROC uniform3f = nullptr;
+        PFNGLUNIFORM3FVPROC uniform3fv = nullptr;
+        PFNGLUNIFORM4FPROC uniform4f = nullptr;
+        PFNGLUNIFORM4FVPROC uniform4fv = nullptr;
+        PFNGLUNIFORMMATRIX2FVPROC uniformMatrix2fv = nullptr;
+        PFNGLUNIFORMMATRIX3FVPROC uniformMatrix3fv = nullptr;
+        PFNGLUNIFORMMATRIX4FVPROC uniformMatrix4fv = nullptr;
+        PFNGLDRAWARRAYSPROC drawArrays = nullptr;
+        PFNGLDRAWELEMENTSPROC drawElements = nullptr;
+        PFNGLDRAWELEMENTSBASEVERTEXPROC drawElementsBaseVertex = nullptr;
+        PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC drawElementsInstancedBaseVertex = nullptr;
+        PFNGLENABLEPROC enable = nullptr;
+        PFNGLDISABLEPROC disable = nullptr;
+        PFNGLMULTIDRAWELEMENTSINDIRECTPROC_EXT multiDrawElementsIndirect = nullptr;
+        PFNGLPROGRAMUNIFORM1IPROC_EXT programUniform1i = nullptr;
+        PFNGLPROGRAMUNIFORM1FPROC_EXT programUniform1f = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform2fv = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform3fv = nullptr;
+        PFNGLPROGRAMUNIFORMFVPROC_EXT programUniform4fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix2fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix3fv = nullptr;
+        PFNGLPROGRAMUNIFORMMATRIXFVPROC_EXT programUniformMatrix4fv = nullptr;
+    };
+
+    // everything that decides what a draw produces, as far as the trace can see
+    struct DrawCall
+    {
+        GLenum mode;
+        GLsizei count;
+        GLenum type;                        // 0 for glDrawArrays
+        const void* indices;                // or the first vertex
+        GLint baseVertex;
+        GLsizei instances;
+        GLuint program;
+        GLuint vao;
+
+        bool operator==(const DrawCall& other) const
+        {
+            return mode == other.mode && count == other.count && type == other.type && indices == other.indices
+                && baseVertex == other.baseVertex && instances == other.instances
+                && program == other.program && vao == other.vao;
+        }
+    };
+
+    struct IndexedBinding
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;                    // -1 for the whole buffer
+    };
+
+    struct Tracer
+    {
+        bool installed = false;
+        Real real;
+
+        // mirror of the bound state
+        GLuint program = 0;
+        GLuint vao = 0;
+        unordered_map<GLenum, GLuint> buffers;
+        unordered_map<uint64_t, IndexedBinding> indexedBuffers;     // target << 32 | index
+        unordered_map<GLenum, bool> capabilities;
+        // uniforms live in the program, so their values are kept across frames
+        unordered_map<uint64_t, vector<unsigned char>> uniforms;    // program << 32 | location
+
+        // bumped by every call that changes what a draw would produce
+        unsigned int stateVersion = 0;
+        bool hasLastDraw = false;
+        DrawCall lastDraw;
+        unsigned int lastDrawVersion = 0;
+
+        GLTraceStats frame;
+        GLTraceStats lastFrame;
+        unsigned int frameCount = 0;
+    };
+
+    static Tracer& tracer()
+    {
+        static Tracer t;
+        return t;
+    }
+
+    static void report(unsigned int frameNumber, const GLTraceStats& s)
+    {
+        cout << "gl trace frame " << frameNumber << ": " << s.calls() << " calls" << endl
+            << "  draws " << s.draws << " (" << s.duplicateDraws << " duplicate, " << s.indirectDraws << " indirect)" << endl
+            << "  program binds " << s.programBinds << " (" << s.redundantProgramBinds << " redundant)" << endl
+            << "  vertex array binds " << s.vaoBinds << " (" << s.redundantVaoBinds << " redundant)" << endl
+            << "  buffer binds " << s.bufferBinds << " (" << s.redundantBufferBinds << " redundant)" << endl
+            << "  uniform writes " << s.uniformWrites << " (" << s.redundantUniformWrites << " redundant, "
+            << s.missingUniformWrites << " to missing uniforms)" << endl
+            << "  uniform lookups " << s.uniformLookups << endl
+            << "  enable/disable " << s.capabilityChanges << " (" << s.redundantCapabilityChanges << " redundant)" << endl;
+    }
+
+    static void recordDraw(const DrawCall& draw)
+    {
+        Tracer& t = tracer();
+        ++t.frame.draws;
+        if (t.hasLastDraw && t.lastDrawVersion == t.stateVersion && t.lastDraw == draw)
+            ++t.frame.duplicateDraws;
+        t.hasLastDraw = true;
+        t.lastDraw = draw;
+        t.lastDrawVersion = t.stateVersion;
+    }
+
+    // glUniform* write the bound program, glProgramUniform* the one they are given
+    static void recordUniform(GLuint program, GLint location, const void* data, size_t bytes)
+    {
+        Tracer& t = tracer();
+        ++t.frame.uniformWrites;
+        if (location < 0)
+        {
+            ++t.frame.missingUniformWrites;
+            return;
+        }
+        vector<unsigned char>& value = t.uniforms[((uint64_t)program << 32) | (uint32_t)location];
+        if (value.size() == bytes && memcmp(value.data(), data, bytes) == 0)
+        {
+            ++t.frame.redundantUniformWrites;
+            return;
+        }
+        value.assign((const unsigned char*)data, (const unsigned char*)data + bytes);
+        ++t.stateVersion;
+    }
+
+    static void recordIndexedBinding(GLenum target, GLuint index, const IndexedBinding& binding)
+    {
+        Tracer& t = tracer();
+        ++t.frame.bufferBinds;
+        // also binds the buffer to the generic target
+        GLuint& generic = t.buffers[target];
+        IndexedBinding& bound = t.indexedBuffers[((uint64_t)target << 32) | index];
+        if (generic == binding.buffer && bound.buffer == binding.buffer && bound.offset == binding.offset && bound.size == binding.size)
+        {
+            ++t.frame.redundantBufferBinds;
+            return;
+        }
+        generic = binding.buffer;
+        bound = binding;
+        ++t.stateVersion;
+    }
+
+    static void recordCapability(GLenum cap, bool enabled)
+    {
+        Tracer& t = tracer();
+        ++t.frame.capabilityChanges;
+        unordered_map<GLenum, bool>::iterator known = t.capabilities.find(cap);
+        if (known != t.capabilities.end() && known->second == enabled)
+        {
+            ++t.frame.redundantCapabilityChanges;
+            return;
+        }
+        t.capabilities[cap] = enabled;
+        ++t.stateVersion;
+    }
+
+    static void APIENTRY useProgram(GLuint program)
+    {
+        Tracer& t = tracer();
+        ++t.frame.programBinds;
+        if (program == t.program)
+            ++t.frame.redundantProgramBinds;
+        else
+            ++t.stateVersion;
+        t.program = program;
+        t.real.useProgram(program);
+    }
+
+    static void APIENTRY bindVertexArray(GLuint vao)
+    {
+        Tracer& t = tracer();
+        ++t.frame.vaoBinds;
+        if (vao == t.vao)
+            ++t.frame.redundantVaoBinds;
+        else
+        {
+            // the element buffer binding belongs to the vertex array
+            t.buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+            ++t.stateVersion;
+        }
+        t.vao = vao;
+        t.real.bindVertexArray(vao);
+    }
+
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer)
+    {
+        Tracer& t = tracer();
+        ++t.frame.bufferBinds;
+        unordered_map<GLenum, GLuint>::iterator bound = t.buffers.find(target);
+        if (bound != t.buffers.end() && bound->second == buffer)
+            ++t.frame.redundantBufferBinds;
+        else
+        {
+            t.buffers[target] = buffer;
+            ++t.stateVersion;
+        }
+        t.real.bindBuffer(target, buffer);
+    }
+
+    static void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        IndexedBinding binding = { buffer, 0, -1 };
+        recordIndexedBinding(target, index, binding);
+        tracer().real.bindBufferBase(target, index, buffer);
+    }
+
+    static void APIENTRY bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        IndexedBinding binding = { buffer, offset, size };
+        recordIndexedBinding(target, index, binding);
+        tracer().real.bindBufferRange(target, index, buffer, offset, size);
+    }
+
+    static GLint APIENTRY getUniformLocation(GLuint program, const GLchar* name)
+    {
+        Tracer& t = tracer();
+        ++t.frame.uniformLookups;
+        return t.real.getUniformLocation(program, name);
+    }
+
+    static void APIENTRY uniform1i(GLint location, GLint v0)
+    {
+        recordUniform(tracer().program, location, &v0, sizeof(v0));
+        tracer().real.uniform1i(location, v0);
+    }
+
+    static void APIENTRY uniform1f(GLint location, GLfloat v0)
+    {
+        recordUniform(tracer().program, location, &v0, sizeof(v0));
+        tracer().real.uniform1f(location, v0);
+    }
+
+    static void APIENTRY uniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        const GLfloat value[] = { v0, v1 };
+        recordUniform(tracer().program, location, value, sizeof(value));
+        tracer().real.uniform2f(location, v0, v1);
+    }
+
+    static void APIENTRY uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 2 * sizeof(GLfloat));
+        tracer().real.uniform2fv(location, count, value);
+    }
+
+    static void APIENTRY uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        const GLfloat value[] = { v0, v1, v2 };
+        recordUniform(tracer().program, location, value, sizeof(value));
+        tracer().real.uniform3f(location, v0, v1, v2);
+    }
+
+    static void APIENTRY uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 3 * sizeof(GLfloat));
+        tracer().real.uniform3fv(location, count, value);
+    }
+
+    static void APIENTRY uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        const GLfloat value[] = { v0, v1, v2, v3 };
+        recordUniform(tracer().program, location, value, sizeof(value));
+        tracer().real.uniform4f(location, v0, v1, v2, v3);
+    }
+
+    static void APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 4 * sizeof(GLfloat));
+        tracer().real.uniform4fv(location, count, value);
+    }
+
+    // the shaders only ever pass untransposed matrices, so transpose is not part of the value
+    static void APIENTRY uniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 4 * sizeof(GLfloat));
+        tracer().real.uniformMatrix2fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 9 * sizeof(GLfloat));
+        tracer().real.uniformMatrix3fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(tracer().program, location, value, count * 16 * sizeof(GLfloat));
+        tracer().real.uniformMatrix4fv(location, count, transpose, value);
+    }
+
+    static void APIENTRY programUniform1i(GLuint program, GLint location, GLint v0)
+    {
+        recordUniform(program, location, &v0, sizeof(v0));
+        tracer().real.programUniform1i(program, location, v0);
+    }
+
+    static void APIENTRY programUniform1f(GLuint program, GLint location, GLfloat v0)
+    {
+        recordUniform(program, location, &v0, sizeof(v0));
+        tracer().real.programUniform1f(program, location, v0);
+    }
+
+    static void APIENTRY programUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 2 * sizeof(GLfloat));
+        tracer().real.programUniform2fv(program, location, count, value);
+    }
+
+    static void APIENTRY programUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 3 * sizeof(GLfloat));
+        tracer().real.programUniform3fv(program, location, count, value);
+    }
+
+    static void APIENTRY programUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 4 * sizeof(GLfloat));
+        tracer().real.programUniform4fv(program, location, count, value);
+    }
+
+    static void APIENTRY programUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 4 * sizeof(GLfloat));
+        tracer().real.programUniformMatrix2fv(program, location, count, transpose, value);
+    }
+
+    static void APIENTRY programUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 9 * sizeof(GLfloat));
+        tracer().real.programUniformMatrix3fv(program, location, count, transpose, value);
+    }
+
+    static void APIENTRY programUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        recordUniform(program, location, value, count * 16 * sizeof(GLfloat));
+        tracer().real.programUniformMatrix4fv(program, location, count, transpose, value);
+    }
+
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        Tracer& t = tracer();
+        DrawCall draw = { mode, count, 0, (const void*)(intptr_t)first, 0, 1, t.program, t.vao };
+        recordDraw(draw);
+        t.real.drawArrays(mode, first, count);
+    }
+
+    static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        Tracer& t = tracer();
+        DrawCall draw = { mode, count, type, indices, 0, 1, t.program, t.vao };
+        recordDraw(draw);
+        t.real.drawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint baseVertex)
+    {
+        Tracer& t = tracer();
+        DrawCall draw = { mode, count, type, indices, baseVertex, 1, t.program, t.vao };
+        recordDraw(draw);
+        t.real.drawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+
+    static void APIENTRY drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+        GLsizei instances, GLint baseVertex)
+    {
+        Tracer& t = tracer();
+        DrawCall draw = { mode, count, type, indices, baseVertex, instances, t.program, t.vao };
+        recordDraw(draw);
+        t.real.drawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+    }
+
+    // the commands come from a buffer the trace does not see written, so an indirect
+    // draw is never taken for a duplicate, nor is the draw after it
+    static void APIENTRY multiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride)
+    {
+        Tracer& t = tracer();
+        ++t.frame.draws;
+        ++t.frame.indirectDraws;
+        t.hasLastDraw = false;
+        t.real.multiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+
+    static void APIENTRY enable(GLenum cap)
+    {
+        recordCapability(cap, true);
+        tracer().real.enable(cap);
+    }
+
+    static void APIENTRY disable(GLenum cap)
+    {
+        recordCapability(cap, false);
+        tracer().real.disable(cap);
+    }
+};
+
+#endif /* glTrace_h */
@@ -1,76 +1,75 @@
 //
-//  sphere.h
+//  hemisphere.h
 
 //
 
 #ifndef hemisphere_h
 #define hemisphere_h
 
-#include <glad/glad.h>
-#include <vector>
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-#include "shader.h"
+#include "primitive.h"
 
-# define PI 3.1416
+// tessellation of a default constructed Hemisphere, baked at compile time
+constexpr float DEFAULT_HEMISPHERE_RADIUS = 1.0f;
+constexpr int DEFAULT_HEMISPHERE_SECTOR_COUNT = 20;
+constexpr int DEFAULT_HEMISPHERE_STACK_COUNT = 18;
 
-using namespace std;
+// the upper half of a sphere's stacks, the top stack meets the pole and the open
+// rim is left as is
+struct HemisphereGeometry
+{
+    typedef SphereLayout Layout;
 
-//const int MIN_SECTOR_COUNT = 3;
-//const int MIN_STACK_COUNT = 2;
+    static constexpr unsigned int vertexCount(int sectorCount, int stackCount)
+    {
+        return (stackCount / 2 + 1) * SurfaceTopology::ringVertexCount(sectorCount);
+    }
+
+    static constexpr unsigned int indexCount(int sectorCount, int stackCount)
+    {
+        return SurfaceTopology::stripIndexCount(sectorCount, stackCount / 2, true, false);
+    }
 
-class Hemisphere
+    template <typename Surface>
+    static constexpr void generate(Surface& surface, float radius, int stackCount)
+    {
+        int bandCount = stackCount / 2;
+        float stackStep = PI / stackCount;
+        for (int i = 0; i <= bandCount; ++i)
+        {
+            float stackAngle = PI / 2 - i * stackStep;
+            float xz = Surface::cosine(stackAngle);
+            float y = Surface::sine(stackAngle);
+            surface.ring(radius * xz, radius * y, xz, y);
+        }
+        surface.strip(0, bandCount, true, false);
+    }
+};
+
+class Hemisphere : public Primitive
 {
 public:
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
     glm::vec3 emmisive;
-    float shininess;
     // ctor/dtor
-    Hemisphere(float radius = 1.0f, int sectorCount = 20, int stackCount = 18, glm::vec3 amb = glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3 diff = glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3 spec = glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3 em = glm::vec3(0.0f, 0.0f, 0.0f), float shiny = 32.0f) : verticesStride(24)
+    Hemisphere(float radius = DEFAULT_HEMISPHERE_RADIUS, int sectorCount = DEFAULT_HEMISPHERE_SECTOR_COUNT, int stackCount = DEFAULT_HEMISPHERE_STACK_COUNT, glm::vec3 amb = glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3 diff = glm::vec3(1.0f, 1.0f, 0.0f), glm::vec3 spec = glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3 em = glm::vec3(0.0f, 0.0f, 0.0f), float shiny = 32.0f)
     {
         set(radius, sectorCount, stackCount, amb, diff, spec,em, shiny);
-        buildCoordinatesAndIndices();
-        buildVertices();
-
-        glGenVertexArrays(1, &sphereVAO);
-        glBindVertexArray(sphereVAO);
-
-        // create VBO to copy vertex data to VBO
-        unsigned int sphereVBO;
-        glGenBuffers(1, &sphereVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);           // for vertex data
-        glBufferData(GL_ARRAY_BUFFER,                   // target
-            this->getVertexSize(), // data size, # of bytes
-            this->getVertices(),   // ptr to vertex data
-            GL_STATIC_DRAW);                   // usage
-
-        // create EBO to copy index data
-        unsigned int sphereEBO;
-        glGenBuffers(1, &sphereEBO);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);   // for index data
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,           // target
-            this->getIndexSize(),             // data size, # of bytes
-            this->getIndices(),               // ptr to index data
-            GL_STATIC_DRAW);                   // usage
-
-        // activate attrib arrays
-        glEnableVertexAttribArray(0);
-        glEnableVertexAttribArray(1);
+        setBoundingSphere(glm::vec3(0.0f), this->radius);
+        createMesh(meshKey(this->radius, this->sectorCount, this->stackCount), &buildMesh, defaultKey(), defaultTable());
+    }
+    ~Hemisphere() {}
 
-        // set attrib arrays with stride and offset
-        int stride = this->getVerticesStride();     // should be 24 bytes
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
+    // the key a Hemisphere built with these arguments uses
+    static MeshKey meshKey(float radius, int sectors, int stacks)
+    {
+        return MeshKey{ MESH_HEMISPHERE, radius, 0.0f, 0.0f, max(sectors, MIN_SECTOR_COUNT), max(stacks, MIN_STACK_COUNT) };
+    }
 
-        // unbind VAO and VBOs
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // starts generating the geometry of such a Hemisphere on the worker pool, ahead of its construction
+    static void prefetch(float radius = DEFAULT_HEMISPHERE_RADIUS, int sectors = DEFAULT_HEMISPHERE_SECTOR_COUNT, int stacks = DEFAULT_HEMISPHERE_STACK_COUNT)
+    {
+        MeshKey key = meshKey(radius, sectors, stacks);
+        prefetchMesh(key, &buildMesh, key == defaultKey());
     }
-    ~Hemisphere() {}
 
     // getters/setters
 
@@ -109,216 +108,53 @@ public:
             set(radius, sectorCount, stacks, ambient, diffuse, specular, emmisive, shininess);
     }
 
-    // for interleaved vertices
-    unsigned int getVertexCount() const
-    {
-        return (unsigned int)coordinates.size() / 3;     // # of vertices
-    }
-
-    unsigned int getVertexSize() const
-    {
-        return (unsigned int)vertices.size() * sizeof(float);  // # of bytes
-    }
-
-    int getVerticesStride() const
-    {
-        return verticesStride;   // should be 24 bytes
-    }
-    const float* getVertices() const
-    {
-        return vertices.data();
-    }
-
-    unsigned int getIndexSize() const
-    {
-        return (unsigned int)indices.size() * sizeof(unsigned int);
-    }
-
-    const unsigned int* getIndices() const
-    {
-        return indices.data();
-    }
-
-    unsigned int getIndexCount() const
-    {
-        return (unsigned int)indices.size();
-    }
-
     // draw in VertexArray mode
     void drawHemiSphere(Shader& lightingShader, glm::mat4 model) const      // draw surface
     {
-        lightingShader.use();
-
-        lightingShader.setVec3("material.ambient", this->ambient);
-        lightingShader.setVec3("material.diffuse", this->diffuse);
-        lightingShader.setVec3("material.specular", this->specular);
-        lightingShader.setVec3("material.emissive", this->emmisive);
-        lightingShader.setFloat("material.shininess", this->shininess);
-
-        lightingShader.setMat4("model", model);
-
-        // draw a sphere with VAO
-        glBindVertexArray(sphereVAO);
-        glDrawElements(GL_TRIANGLES,                    // primitive type
-            this->getIndexCount(),          // # of indices
-            GL_UNSIGNED_INT,                 // data type
-            (void*)0);                       // offset to indices
+        drawPrimitive(lightingShader, model);
+    }
 
-        // unbind VAO
-        glBindVertexArray(0);
+    MaterialState getMaterial() const override
+    {
+        MaterialState material = Primitive::getMaterial();
+        material.emissive = this->emmisive;
+        return material;
     }
 
 private:
     // member functions
-    void buildCoordinatesAndIndices()
+    static void buildMesh(const MeshKey& key, vector<float>& vertices, vector<unsigned int>& indices)
     {
-        float x, y, z, xz;                              // vertex position
-        float nx, ny, nz, lengthInv = 1.0f / radius;    // vertex normal
-
-        float sectorStep = 2 * PI / sectorCount;
-        float stackStep = PI / stackCount;
-        float sectorAngle = -sectorStep;
-        float stackAngle = PI / 2 + stackStep;
-
-        for (int i = 0; i <= stackCount; ++i)
-        {
-            stackAngle -= stackStep;        // starting from pi/2 to -pi/2
-            xz = radius * cosf(stackAngle);
-            y = radius * sinf(stackAngle);
-            // add (sectorCount+1) vertices per stack
-            // first and last vertices have same position and normal, but different tex coords
-            for (int j = 0; j <= sectorCount; ++j)
-            {
-                sectorAngle += sectorStep;           // starting from 0 to 2pi
-
-                // vertex position (x, y, z)
-                z = xz * cosf(sectorAngle);
-                x = xz * sinf(sectorAngle);
-                coordinates.push_back(x);
-                coordinates.push_back(y);
-                coordinates.push_back(z);
-
-                // normalized vertex normal (nx, ny, nz)
-                nx = x * lengthInv;
-                ny = y * lengthInv;
-                nz = z * lengthInv;
-                normals.push_back(nx);
-                normals.push_back(ny);
-                normals.push_back(nz);
-            }
-        }
-
-        // generate index list of sphere triangles
-        // k1--k1+1
-        // |  / |
-        // | /  |
-        // k2--k2+1
-
-        int k1, k2;
-        for (int i = 0; i < stackCount/2; ++i)
-        {
-            k1 = i * (sectorCount + 1);     // beginning of current stack
-            k2 = k1 + sectorCount + 1;      // beginning of next stack
-
-            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
-            {
-                // 2 triangles per sector excluding first and last stacks
-                if (i != 0 && i != (stackCount - 1))
-                {
-                    // k1 => k2 => k1+1
-                    indices.push_back(k1);
-                    indices.push_back(k2);
-                    indices.push_back(k1 + 1);
-
-                    // k1+1 => k2 => k2+1
-                    indices.push_back(k1 + 1);
-                    indices.push_back(k2);
-                    indices.push_back(k2 + 1);
-                }
-                // 2 triangles per sector excluding first and last stacks
-                else if (i == 0)
-                {
-                    indices.push_back(k1 + 1);
-                    indices.push_back(k2);
-                    indices.push_back(k2 + 1);
-
-                }
-
-                else if (i == (stackCount - 1))
-                {
-                    indices.push_back(k1);
-                    indices.push_back(k2);
-                    indices.push_back(k1 + 1);
-                }
-            }
-        }
+        vertices.resize((size_t)HemisphereGeometry::vertexCount(key.sectorCount, key.stackCount) * 6);
+        indices.resize(HemisphereGeometry::indexCount(key.sectorCount, key.stackCount));
+        SurfaceOfRevolution<SphereLayout> surface(key.sectorCount, 2 * PI, vertices.data(), indices.data());
+        HemisphereGeometry::generate(surface, key.radius, key.stackCount);
     }
 
-    void buildVertices()
+    static MeshKey defaultKey()
     {
-        size_t i, j;
-        size_t count = coordinates.size();
-        for (i = 0, j = 0; i < count; i += 3, j += 2)
-        {
-            vertices.push_back(coordinates[i]);
-            vertices.push_back(coordinates[i + 1]);
-            vertices.push_back(coordinates[i + 2]);
-
-            vertices.push_back(normals[i]);
-            vertices.push_back(normals[i + 1]);
-            vertices.push_back(normals[i + 2]);
-        }
+        return meshKey(DEFAULT_HEMISPHERE_RADIUS, DEFAULT_HEMISPHERE_SECTOR_COUNT, DEFAULT_HEMISPHERE_STACK_COUNT);
     }
 
-    vector<float> computeFaceNormal(float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3)
-    {
-        const float EPSILON = 0.000001f;
-
-        vector<float> normal(3, 0.0f);     // default return value (0,0,0)
-        float nx, ny, nz;
-
-        // find 2 edge vectors: v1-v2, v1-v3
-        float ex1 = x2 - x1;
-        float ey1 = y2 - y1;
-        float ez1 = z2 - z1;
-        float ex2 = x3 - x1;
-        float ey2 = y3 - y1;
-        float ez2 = z3 - z1;
-
-        // cross product: e1 x e2
-        nx = ey1 * ez2 - ez1 * ey2;
-        ny = ez1 * ex2 - ex1 * ez2;
-        nz = ex1 * ey2 - ey1 * ex2;
+    typedef GeometryTable<HemisphereGeometry::vertexCount(DEFAULT_HEMISPHERE_SECTOR_COUNT, DEFAULT_HEMISPHERE_STACK_COUNT),
+        HemisphereGeometry::indexCount(DEFAULT_HEMISPHERE_SECTOR_COUNT, DEFAULT_HEMISPHERE_STACK_COUNT)> DefaultTable;
 
-        // normalize only if the length is > 0
-        float length = sqrtf(nx * nx + ny * ny + nz * nz);
-        if (length > EPSILON)
-        {
-            // normalize
-            float lengthInv = 1.0f / length;
-            normal[0] = nx * lengthInv;
-            normal[1] = ny * lengthInv;
-            normal[2] = nz * lengthInv;
-        }
-
-        return normal;
+    static const DefaultTable& defaultTable()
+    {
+        static constexpr DefaultTable table = makeGeometryTable<HemisphereGeometry, DefaultTable>(
+            DEFAULT_HEMISPHERE_SECTOR_COUNT, 2 * PI, DEFAULT_HEMISPHERE_RADIUS, DEFAULT_HEMISPHERE_STACK_COUNT);
+        return table;
     }
 
     // memeber vars
-    unsigned int sphereVAO;
     float radius;
     int sectorCount;                        // longitude, # of slices
     int stackCount;                         // latitude, # of stacks
-    vector<float> vertices;
-    vector<float> normals;
-    vector<unsigned int> indices;
-    vector<float> coordinates;
-    int verticesStride;                 // # of bytes to hop to the next vertex (should be 24 bytes)
 
 };
 
 
-#endif /* sphere_h */
+#endif /* hemisphere_h */
 
 
 #pragma once
@@ -0,0 +1,154 @@
+//
+//  instanceBatch.h
+//  copies of one mesh collected over a frame and drawn with a single
+//  instanced call, model matrix, normal matrix and material index coming from per-instance attributes
+//
+
+#ifndef instanceBatch_h
+#define instanceBatch_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "mesh.h"
+#include "shader.h"
+#include "streamBuffer.h"
+#include "glState.h"
+#include "materialTable.h"
+#include "transform.h"
+#include "frustum.h"
+
+using namespace std;
+
+// attribute locations of the instance data, after position (0) and normal (1)
+const unsigned int INSTANCE_MODEL_LOCATION = 2;        // mat4, takes locations 2 to 5, the material index is at MATERIAL_ID_LOCATION
+const unsigned int INSTANCE_NORMAL_MATRIX_LOCATION = 10;  // mat3, takes locations 10 to 12
+
+// one instance as it is laid out in the instance buffer
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::mat3 normalMatrix;                 // computed once here instead of per vertex
+    GLuint material;                        // into the Materials block
+};
+
+class InstanceBatch
+{
+public:
+    // maxInstances is the most one frame may add, the rest is dropped with a message
+    InstanceBatch(const Mesh& mesh, unsigned int maxInstances)
+        : mesh(mesh), instanceStream(GL_ARRAY_BUFFER, maxInstances * sizeof(InstanceData)), maxInstances(maxInstances)
+    {
+        instances.reserve(maxInstances);
+    }
+
+    InstanceBatch(const InstanceBatch&) = delete;
+    InstanceBatch& operator=(const InstanceBatch&) = delete;
+
+    // color is both the ambient and the diffuse color
+    void add(const glm::mat4& model, const glm::vec3& color, const glm::vec3& specular, float shininess,
+        const glm::vec3& emissive = glm::vec3(0.0f))
+    {
+        if (!FrustumCulling::isVisible(mesh.getBounds(), model))
+            return;
+        // the frame's slice of the instance buffer holds no more
+        if (instances.size() >= maxInstances)
+        {
+            if (!overflowReported)
+                cout << "instance batch: more than " << maxInstances << " instances in a frame, dropping the rest" << endl;
+            overflowReported = true;
+            return;
+        }
+        MaterialState material;
+        material.ambient = material.diffuse = color;
+        material.specular = specular;
+        material.emissive = emissive;
+        material.shininess = shininess;
+        MaterialTable* table = MaterialTable::current();
+        InstanceData instance = { model, normalMatrix(model), table != nullptr ? table->intern(material) : 0 };
+        instances.push_back(instance);
+    }
+
+    // same fencing as the frame's other stream buffers
+    void beginFrame() { instanceStream.beginFrame(); }
+    void endFrame() { instanceStream.endFrame(); }
+
+    // draws everything added since the last flush with the shader's instanced path
+    void flush(Shader& shader)
+    {
+        if (instances.empty() || mesh.getPool() == nullptr)
+        {
+            instances.clear();
+            return;
+        }
+        StreamRange range = instanceStream.write(instances.data(), instances.size() * sizeof(InstanceData));
+        if (!range.valid())
+        {
+            instances.clear();
+            return;
+        }
+
+        // the instance attributes are added to the pool's VAO for this draw only
+        mesh.getPool()->bind();
+        GLState::bindBuffer(GL_ARRAY_BUFFER, instanceStream.getBuffer());
+        const GLsizei stride = sizeof(InstanceData);
+        for (unsigned int column = 0; column < 4; ++column)
+        {
+            setInstanceAttribute(INSTANCE_MODEL_LOCATION + column, 4, range.offset + offsetof(InstanceData, model) + column * sizeof(glm::vec4), stride);
+        }
+        for (unsigned int column = 0; column < 3; ++column)
+        {
+            setInstanceAttribute(INSTANCE_NORMAL_MATRIX_LOCATION + column, 3, range.offset + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3), stride);
+        }
+        glEnableVertexAttribArray(MATERIAL_ID_LOCATION);
+        glVertexAttribIPointer(MATERIAL_ID_LOCATION, 1, GL_UNSIGNED_INT, stride, (void*)(range.offset + offsetof(InstanceData, material)));
+        glVertexAttribDivisor(MATERIAL_ID_LOCATION, 1);
+
+        shader.use();
+        const GLint instanced = instancedUniform.get(shader);
+        shader.setBool(instanced, true);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.getIndexCount(), mesh.getIndexType(),
+            (void*)mesh.getIndexOffset(), (GLsizei)instances.size(), mesh.getBaseVertex());
+        shader.setBool(instanced, false);
+
+        for (unsigned int column = 0; column < 4; ++column)
+            glDisableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+        for (unsigned int column = 0; column < 3; ++column)
+            glDisableVertexAttribArray(INSTANCE_NORMAL_MATRIX_LOCATION + column);
+        glDisableVertexAttribArray(MATERIAL_ID_LOCATION);
+
+        instanceCount = (unsigned int)instances.size();
+        instances.clear();
+    }
+
+    // free the instance buffer; safe to call more than once
+    void release()
+    {
+        instanceStream.release();
+    }
+
+    // waiting to be flushed
+    size_t size() const { return instances.size(); }
+    // instances in the last flush
+    unsigned int getInstanceCount() const { return instanceCount; }
+
+private:
+    static void setInstanceAttribute(unsigned int location, GLint components, size_t offset, GLsizei stride)
+    {
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, components, GL_FLOAT, false, stride, (void*)offset);
+        glVertexAttribDivisor(location, 1);
+    }
+
+    const Mesh& mesh;
+    StreamBuffer instanceStream;
+    vector<InstanceData> instances;
+    const unsigned int maxInstances;
+    bool overflowReported = false;
+    UniformHandle instancedUniform = UniformHandle("instanced");
+    unsigned int instanceCount = 0;
+};
+
+#endif /* instanceBatch_h */
@@ -0,0 +1,100 @@
+//
+//  lightBlock.h
+//  the scene's lights in one uniform buffer shared by every lighting program;
+//  the lights write into a CPU copy and the buffer is only updated when it changed
+//
+
+#ifndef lightBlock_h
+#define lightBlock_h
+
+#include <glad/glad.h>
+#include <cstring>
+#include "glState.h"
+#include "uniformBlocks.h"
+
+class LightBlock
+{
+public:
+    LightBlock()
+    {
+        glGenBuffers(1, &buffer);
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightUniforms), &lights, GL_DYNAMIC_DRAW);
+        // stays bound, every program reads the lights from the same binding point
+        GLState::bindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, buffer);
+    }
+
+    ~LightBlock()
+    {
+        release();
+    }
+
+    LightBlock(const LightBlock&) = delete;
+    LightBlock& operator=(const LightBlock&) = delete;
+
+    // index is 0 based; lights past MAX_POINT_LIGHTS are ignored
+    void setPointLight(unsigned int index, const PointLightUniform& light)
+    {
+        if (index >= MAX_POINT_LIGHTS)
+            return;
+        write(lights.pointLights[index], light);
+        if ((int)index >= lights.pointLightCount)
+        {
+            lights.pointLightCount = index + 1;
+            dirty = true;
+        }
+    }
+
+    void setSpotLight(const SpotLightUniform& light)
+    {
+        write(lights.spotLight, light);
+    }
+
+    void setDirectionalLight(const DirectionalLightUniform& light)
+    {
+        write(lights.directionalLight, light);
+    }
+
+    // one glBufferSubData of the whole block, only if a light changed since the last upload
+    void upload()
+    {
+        if (!dirty || buffer == 0)
+            return;
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightUniforms), &lights);
+        dirty = false;
+        ++uploads;
+    }
+
+    // free the uniform buffer; safe to call more than once
+    void release()
+    {
+        if (buffer != 0)
+        {
+            GLState::forgetBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+    }
+
+    bool isDirty() const { return dirty; }
+    unsigned int getUploadCount() const { return uploads; }
+
+private:
+    // compared bytewise, the padding is zeroed by the lights that fill the structs
+    template <typename Light>
+    void write(Light& current, const Light& light)
+    {
+        if (memcmp(&current, &light, sizeof(Light)) == 0)
+            return;
+        current = light;
+        dirty = true;
+    }
+
+    LightUniforms lights = {};
+    GLuint buffer = 0;
+    bool dirty = true;
+    unsigned int uploads = 0;
+};
+
+#endif /* lightBlock_h */
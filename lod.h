@@ -0,0 +1,92 @@
+//
+//  lod.h
+//  screen space driven level of detail selection for the curved primitives
+//
+
+#ifndef lod_h
+#define lod_h
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+// a level halves the sectors (and stacks) of the previous one, down to this many sectors
+const int LOD_MIN_SECTOR_COUNT = 8;
+const int LOD_MAX_LEVELS = 4;
+// target on-screen length of one sector edge, in pixels
+const float LOD_PIXELS_PER_SEGMENT = 12.0f;
+// a coarser level is taken only once it has this much more detail than needed
+const float LOD_HYSTERESIS = 0.25f;
+
+// camera of the current frame; set once per frame before drawing
+class LodContext
+{
+public:
+    static void setFrame(const glm::mat4& view, const glm::mat4& projection, float viewportHeight)
+    {
+        Frame& frame = current();
+        frame.view = view;
+        frame.pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;    // at distance 1
+        frame.valid = true;
+    }
+
+    // stop selecting levels, everything draws at full detail
+    static void clearFrame()
+    {
+        current().valid = false;
+    }
+
+    static bool hasFrame()
+    {
+        return current().valid;
+    }
+
+    // radius in pixels of the object space bounding sphere once transformed by model
+    static float projectedRadius(const glm::mat4& model, const glm::vec3& center, float radius)
+    {
+        const Frame& frame = current();
+        float scale = glm::length(glm::vec3(model[0]));
+        scale = fmaxf(scale, glm::length(glm::vec3(model[1])));
+        scale = fmaxf(scale, glm::length(glm::vec3(model[2])));
+        float worldRadius = radius * scale;
+
+        glm::vec4 viewCenter = frame.view * model * glm::vec4(center, 1.0f);
+        float distance = -viewCenter.z;
+        if (distance <= worldRadius)
+            return numeric_limits<float>::max();    // the camera is inside or touching it
+        return worldRadius * frame.pixelsPerUnit / distance;
+    }
+
+    // level to draw given the sector count of every level (finest first) and the level
+    // used last time; refines immediately, coarsens only past the hysteresis margin
+    static int selectLevel(const int* sectorCounts, int levelCount, int currentLevel, float radiusPixels)
+    {
+        const float twoPi = 6.2831853f;
+        float wanted = twoPi * radiusPixels / LOD_PIXELS_PER_SEGMENT;
+
+        int level = currentLevel < levelCount ? currentLevel : levelCount - 1;
+        while (level > 0 && sectorCounts[level] < wanted)
+            --level;
+        while (level + 1 < levelCount && sectorCounts[level + 1] >= wanted * (1.0f + LOD_HYSTERESIS))
+            ++level;
+        return level;
+    }
+
+private:
+    struct Frame
+    {
+        glm::mat4 view = glm::mat4(1.0f);
+        float pixelsPerUnit = 0.0f;
+        bool valid = false;
+    };
+
+    static Frame& current()
+    {
+        static Frame frame;
+        return frame;
+    }
+};
+
+#endif /* lod_h */
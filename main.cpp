@@ -21,8 +21,24 @@
 #include "cone.h"
 #include "cylinder.h"
 #include "hemisphere.h"
+#include "mesh.h"
+#include "geometryTables.h"
+#include "glExtensions.h"
+#include "assetPack.h"
+#include "streamBuffer.h"
+#include "uniformBlocks.h"
+#include "instanceBatch.h"
+#include "renderQueue.h"
+#include "staticGeometry.h"
+#include "materialTable.h"
+#include "glTrace.h"
+#include "sceneGraph.h"
+#include "transformBenchmark.h"
+#include "frustum.h"
 
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 
 using namespace std;
 
@@ -32,21 +48,81 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
 void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model, float r, float g, float b,float a);
-void bed(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 alTogether);
+
+// one cube of a piece of furniture, drawn at the world matrix of its scene node
+struct SceneCube
+{
+    SceneNode node;
+    glm::vec3 color;
+};
+
+// the fan's blades turn about the hub, the stand hangs from the fan's parent
+struct FanNodes
+{
+    SceneNode hub;
+    SceneNode blades[2];
+    SceneNode stand;
+};
+
+struct GhostNodes
+{
+    SceneNode body;
+    SceneNode tail;
+};
+
+// what a ghost is drawn with, built once; every ghost has its own, so its level of
+// detail carries over from frame to frame
+struct GhostParts
+{
+    Hemisphere body{ 1.0f, 36, 18, glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f),
+        glm::vec3(0.1f, 0.1f, 0.3f), 2.0f };   // emissive color (this makes it glow)
+    Cone tail{ 1.0f, 2.0f, 36, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), 32.0f };
+};
+
+// everything the render loop draws outside the baked geometry
+struct ClassroomNodes
+{
+    SceneNode modelling;
+    SceneNode globe;
+    SceneNode globeHandle;
+    SceneNode cylinder;
+    SceneNode hemisphere;
+    GhostNodes ghosts[2];
+    FanNodes fans[4];               // not built while the fans are disabled
+    vector<SceneCube> fanCubes;
+};
+
+// scene graph builders: each adds its parts below parent, the cubes to cubes
+SceneNode addSceneCube(SceneGraph& scene, SceneNode parent, const glm::mat4& local, const glm::vec3& color, vector<SceneCube>& cubes);
+void drawSceneCubes(unsigned int& cubeVAO, Shader& lightingShader, const SceneGraph& scene, const vector<SceneCube>& cubes);
+void addBed(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes);
+void addTabChairBook(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes);
+FanNodes addFan(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes);
+void spinFan(SceneGraph& scene, const FanNodes& fan, bool fanOn, float& r);
+glm::mat4 fanBladeTransform(float angle);
+void addAlmirah(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes);
+GhostNodes addGhostSculpture(SceneGraph& scene, glm::vec3 position, glm::mat4 model);
+void drawGhostSculpture(Shader& shaderProgram, const SceneGraph& scene, const GhostNodes& ghost, const GhostParts& parts);
+ClassroomNodes buildClassroomScene(SceneGraph& scene);
 // draw object functions
-void drawTabChairBook(Shader& shaderProgram, unsigned int VAO, glm::mat4 parentTrans);
 void drawWallsAndFloorWithCarpet(Shader& shaderProgram, unsigned int VAO, glm::mat4 model);
 void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO);
-void drawFan(Shader& shaderProgram, unsigned int VAO, glm::mat4 parentTrans, bool fanOn, float& r);
-void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 alTogether);
+void classroom(Shader& lightingShader, const SceneGraph& scene, const ClassroomNodes& nodes, const GhostParts ghostParts[2]);
+void classroomStatic(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model);
 glm::mat4 customPerspective(float fovRadians, float aspect, float near, float far);
-void drawAlmirah(Shader& shaderProgram, unsigned int VAO, glm::mat4 model);
 
 
 // settings
 const unsigned int SCR_WIDTH = 1200;
 const unsigned int SCR_HEIGHT = 1000;
 
+// the cube mesh, for the helpers below that draw it directly
+Mesh* cubeMesh = nullptr;
+// drawCube() only collects its cube here, all of them are drawn in one call per frame
+InstanceBatch* cubeBatch = nullptr;
+// while set, drawCube() bakes its cube into this static geometry instead
+StaticGeometry* staticBake = nullptr;
+
 // modelling transform
 float rotateAngle_X = 0.0;
 float rotateAngle_Y = 0.0;
@@ -161,8 +237,68 @@ bool fanOn1 = false, fanOn2 = false, fanOn3 = false, fanOn4 = false;
 float deltaTime = 0.0f;    // time between current frame and last frame
 float lastFrame = 0.0f;
 
-int main()
+int main(int argc, char** argv)
 {
+    // --trace-gl: count every frame's GL calls and report the redundant ones
+    // --bench-transforms [count]: time the matrix kernels against glm and exit, no window
+    bool traceGL = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--trace-gl") == 0)
+            traceGL = true;
+        else if (strcmp(argv[i], "--bench-transforms") == 0)
+        {
+            unsigned int objects = TRANSFORM_BENCHMARK_OBJECTS;
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                objects = (unsigned int)atoi(argv[i + 1]);
+            TransformBenchmark::run(objects);
+            return 0;
+        }
+    }
+
+    // geometry lives on the GPU only, Mesh reads it back if anybody asks for it
+    Mesh::setKeepHostCopies(false);
+    // half float positions and packed normals, 12 bytes per vertex instead of 24
+    Mesh::setVertexFormat(VERTEX_COMPACT);
+
+    // pre-generated meshes and shader sources; whatever the pack lacks or has out of
+    // date is built from the sources instead, and the pack is rewritten on exit
+    AssetPack assets;
+    bool assetsLoaded = assets.open(ASSET_PACK_PATH);
+    if (assetsLoaded)
+        AssetPack::setCurrent(&assets);
+
+    float globeRadius = 1.0f;                 // Radius of the globe
+    int globeSectorCount = 36;               // Smoothness of the sphere
+    int globeStackCount = 18;
+    glm::vec3 globeAmbient(0.1f, 0.1f, 0.8f); // Blueish ambient color
+    glm::vec3 globeDiffuse(0.2f, 0.2f, 0.9f); // Slightly brighter diffuse blue
+    glm::vec3 globeSpecular(0.1f, 0.1f, 0.1f); // Bright white specular highlights
+    float globeShininess = 32.0f;            // Shininess for the globe
+
+    // Create a cylinder (as the handle)
+    float baseRadius = 0.06f;   // Smaller base radius for the handle
+    float topRadius = 0.06f;    // Same as base to make it cylindrical
+    float height = 0.25f;       // Length of the handle
+    int sectorCount = 20;      // Smoothness of the cylinder
+    int stackCount = 10;       // Stack divisions
+    glm::vec3 ambientColor(0.2f, 0.5f, 0.7f); // Blueish ambient color
+    glm::vec3 diffuseColor(0.2f, 0.5f, 0.7f); // Blueish diffuse color
+    glm::vec3 specularColor(0.1f, 0.1f, 0.1f); // Bright specular highlights
+    float shininess = 32.0f;   // Shininess factor for the handle
+
+    // the scene's meshes are generated on worker threads while the window, the context and
+    // the shaders are set up below; the constructors further down then only upload them
+    Sphere::prefetch(globeRadius, globeSectorCount, globeStackCount);
+    Sphere::prefetch();
+    Hemisphere::prefetch();
+    Cone::prefetch();
+    Cylinder::prefetch();
+    Cylinder::prefetch(baseRadius, topRadius, height, sectorCount, stackCount);
+    // the ghosts' body and tail
+    Hemisphere::prefetch(1.0f, 36, 18);
+    Cone::prefetch(1.0f, 2.0f, 36);
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -198,152 +334,88 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // newer entry points (buffer storage) where the driver has them
+    GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+    if (traceGL)
+        GLTrace::install();
 
     // configure global opengl state
     // -----------------------------
-    glEnable(GL_DEPTH_TEST);
+    GLState::setDepthTest(true);
 
     // build and compile our shader zprogram
     // ------------------------------------
+    // every shader source the program may load, baked into the asset pack
+    const char* const shaderPaths[] = {
+        "vertexShaderForPhongShading.vs", "fragmentShaderForPhongShading.fs",
+        "vertexShaderForGouraudShading.vs", "fragmentShaderForGouraudShading.fs",
+        "vertexShader.vs", "fragmentShader.fs",
+        "vertexShaderForPhongShadingIndirect.vs"
+    };
     Shader lightingShader("vertexShaderForPhongShading.vs", "fragmentShaderForPhongShading.fs");
     //Shader lightingShader("vertexShaderForGouraudShading.vs", "fragmentShaderForGouraudShading.fs");
     Shader ourShader("vertexShader.vs", "fragmentShader.fs");
+    lightingShader.bindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    lightingShader.bindUniformBlock("Materials", MATERIAL_BLOCK_BINDING);
+    lightingShader.bindUniformBlock("Lights", LIGHT_BLOCK_BINDING);
+    ourShader.bindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+    // the same lighting, with model and material per draw from a storage buffer; GL 4.3 and up only
+    Shader* indirectShader = nullptr;
+    if (GLExtensions::hasMultiDrawIndirect())
+    {
+        indirectShader = new Shader("vertexShaderForPhongShadingIndirect.vs", "fragmentShaderForPhongShading.fs");
+        if (indirectShader->linked)
+        {
+            indirectShader->bindUniformBlock("FrameData", FRAME_BLOCK_BINDING);
+            indirectShader->bindUniformBlock("Materials", MATERIAL_BLOCK_BINDING);
+            indirectShader->bindUniformBlock("Lights", LIGHT_BLOCK_BINDING);
+        }
+        else
+        {
+            // the queue keeps drawing one packet at a time with the regular shader
+            std::cout << "multi-draw indirect: shader failed to link, drawing without it" << std::endl;
+            glDeleteProgram(indirectShader->ID);
+            delete indirectShader;
+            indirectShader = nullptr;
+        }
+    }
+
+    // per-frame uniform data, triple buffered
+    StreamBuffer frameStream(GL_UNIFORM_BUFFER, 16 * 1024);
+    // the lights, rewritten only after one of the keys 1 to 7 changed them
+    LightBlock lightBlock;
+    // every distinct material once; draws, instances and baked vertices only carry its index
+    MaterialTable materialTable;
+    MaterialTable::setCurrent(&materialTable);
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
 
-    float cube_vertices[] = {
-        // Positions          // Normals
-        // Front face
-        0.0f, 0.0f, 0.5f,     0.0f, 0.0f, 1.0f,
-        0.5f, 0.0f, 0.5f,     0.0f, 0.0f, 1.0f,
-        0.5f, 0.5f, 0.5f,     0.0f, 0.0f, 1.0f,
-        0.0f, 0.5f, 0.5f,     0.0f, 0.0f, 1.0f,
-
-        // Back face
-        0.0f, 0.0f, 0.0f,     0.0f, 0.0f, -1.0f,
-        0.5f, 0.0f, 0.0f,     0.0f, 0.0f, -1.0f,
-        0.5f, 0.5f, 0.0f,     0.0f, 0.0f, -1.0f,
-        0.0f, 0.5f, 0.0f,     0.0f, 0.0f, -1.0f,
-
-        // Left face
-        0.0f, 0.0f, 0.0f,     -1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.5f,     -1.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.5f,     -1.0f, 0.0f, 0.0f,
-        0.0f, 0.5f, 0.0f,     -1.0f, 0.0f, 0.0f,
-
-        // Right face
-        0.5f, 0.0f, 0.0f,     1.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.5f,     1.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.5f,     1.0f, 0.0f, 0.0f,
-        0.5f, 0.5f, 0.0f,     1.0f, 0.0f, 0.0f,
-
-        // Top face
-        0.0f, 0.5f, 0.0f,     0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.0f,     0.0f, 1.0f, 0.0f,
-        0.5f, 0.5f, 0.5f,     0.0f, 1.0f, 0.0f,
-        0.0f, 0.5f, 0.5f,     0.0f, 1.0f, 0.0f,
-
-        // Bottom face
-        0.0f, 0.0f, 0.0f,     0.0f, -1.0f, 0.0f,
-        0.5f, 0.0f, 0.0f,     0.0f, -1.0f, 0.0f,
-        0.5f, 0.0f, 0.5f,     0.0f, -1.0f, 0.0f,
-        0.0f, 0.0f, 0.5f,     0.0f, -1.0f, 0.0f,
-    };
-
-
-    /*float cube_vertices[] = {
-        // positions      // normals
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f,
-        1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f,
-        1.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f,
-        0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f,
-
-        1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-        1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-        1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
-        1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,
-
-        0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-        0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-
-        0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
-
-        1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-        1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
-
-        0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f,
-        1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f,
-        1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f,
-        0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f
-    };*/
-    unsigned int cube_indices[] = {
-        0, 3, 2,
-        2, 1, 0,
-
-        4, 5, 7,
-        7, 6, 4,
-
-        8, 9, 10,
-        10, 11, 8,
-
-        12, 13, 14,
-        14, 15, 12,
-
-        16, 17, 18,
-        18, 19, 16,
-
-        20, 21, 22,
-        22, 23, 20
-    };
-
-    unsigned int cubeVAO, cubeVBO, cubeEBO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-    glGenBuffers(1, &cubeEBO);
-
-    glBindVertexArray(cubeVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cube_vertices), cube_vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cube_indices), cube_indices, GL_STATIC_DRAW);
-
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // vertex normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)12);
-    glEnableVertexAttribArray(1);
-
-    // second, configure the light's VAO (VBO stays the same; the vertices are the same for the light object which is also a 3D cube)
-    unsigned int lightCubeVAO;
-    glGenVertexArrays(1, &lightCubeVAO);
-    glBindVertexArray(lightCubeVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    float globeRadius = 1.0f;                 // Radius of the globe
-    int globeSectorCount = 36;               // Smoothness of the sphere
-    int globeStackCount = 18;
-    glm::vec3 globeAmbient(0.1f, 0.1f, 0.8f); // Blueish ambient color
-    glm::vec3 globeDiffuse(0.2f, 0.2f, 0.9f); // Slightly brighter diffuse blue
-    glm::vec3 globeSpecular(0.1f, 0.1f, 0.1f); // Bright white specular highlights
-    float globeShininess = 32.0f;            // Shininess for the globe
+    // half unit cube with one corner at the origin, generated at compile time
+    static constexpr GeometryTable<24, 36> cubeTable = makeCubeTable(0.5f);
+
+    // the cube goes through the same Mesh upload path as the procedural primitives
+    Mesh cube(cubeTable.vertices, cubeTable.vertexCount * 6, cubeTable.indices, cubeTable.indexCount);
+    unsigned int cubeVAO = cube.getVAO();
+    cubeMesh = &cube;
+    InstanceBatch cubeInstances(cube, 256);
+    cubeBatch = &cubeInstances;
+
+    // the primitives' draws are sorted by program, VAO, material and depth before they reach GL
+    RenderQueue renderQueue;
+    RenderQueue::setCurrent(&renderQueue);
+    renderQueue.setIndirectShader(lightingShader, indirectShader);
+
+    // walls, floor, furniture: world space once, then a single draw per frame. The
+    // modelling transform of the render loop is the identity (its keys are disabled)
+    StaticGeometry classroomScenery;
+    staticBake = &classroomScenery;
+    classroomStatic(cubeVAO, lightingShader, glm::mat4(1.0f));
+    staticBake = nullptr;
+    classroomScenery.upload();
+    if (traceGL)
+        std::cout << "static geometry: " << classroomScenery.getVertexCount() << " vertices, " << classroomScenery.getIndexCount() / 3 << " triangles" << std::endl;
+    cube.releaseHostData();
 
     Sphere globe(globeRadius, globeSectorCount, globeStackCount,
                  globeAmbient, globeDiffuse, globeSpecular, globeShininess);
@@ -353,20 +425,16 @@ int main()
     
     Cone cone = Cone();
     Cylinder cylinder = Cylinder();
-    // Create a cylinder (as the handle)
-    float baseRadius = 0.06f;   // Smaller base radius for the handle
-    float topRadius = 0.06f;    // Same as base to make it cylindrical
-    float height = 0.25f;       // Length of the handle
-    int sectorCount = 20;      // Smoothness of the cylinder
-    int stackCount = 10;       // Stack divisions
-    glm::vec3 ambientColor(0.2f, 0.5f, 0.7f); // Blueish ambient color
-    glm::vec3 diffuseColor(0.2f, 0.5f, 0.7f); // Blueish diffuse color
-    glm::vec3 specularColor(0.1f, 0.1f, 0.1f); // Bright specular highlights
-    float shininess = 32.0f;   // Shininess factor for the handle
+    GhostParts ghostParts[2];
 
     Cylinder handle(baseRadius, topRadius, height, sectorCount, stackCount,
         ambientColor, diffuseColor, specularColor, shininess);
 
+    // local transforms of the scene are set once; per frame only the nodes below a
+    // transform that changed get a new world matrix
+    SceneGraph scene;
+    ClassroomNodes classroomNodes = buildClassroomScene(scene);
+
 
 
 
@@ -379,6 +447,7 @@ int main()
 
     // render loop
     // -----------
+    bool firstFrame = true;
     while (!glfwWindowShouldClose(window))
     {
         // per-frame time logic
@@ -395,19 +464,24 @@ int main()
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);  // Set background color to black
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);  // Clear screen and depth buffer
+        GLTrace::beginFrame();
+        frameStream.beginFrame();
+        cubeInstances.beginFrame();
+        renderQueue.beginFrame();
 
 
         // be sure to activate shader when setting uniforms/drawing objects
         lightingShader.use();
-        lightingShader.setVec3("viewPos", camera.Position);
 
         // point light 1
-        pointlight1.setUpPointLight(lightingShader);
+        pointlight1.setUpPointLight(lightBlock);
         // point light 2
-        pointlight2.setUpPointLight(lightingShader);
+        pointlight2.setUpPointLight(lightBlock);
         
-        spotlight.setUpSpotLight(lightingShader);
-        directionallight.setUpDirectionalLight(lightingShader);
+        spotlight.setUpSpotLight(lightBlock);
+        directionallight.setUpDirectionalLight(lightBlock);
+        // every lighting program reads the same block, nothing is sent unless a light changed
+        lightBlock.upload();
 
         
 
@@ -428,16 +502,24 @@ int main()
 
         glm::mat4 projection = customPerspective(fov, aspect, near, far);
 
-        lightingShader.setMat4("projection", projection);
-
         //glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         //glm::mat4 projection = glm::ortho(-2.0f, +2.0f, -1.5f, +1.5f, 0.1f, 100.0f);
-        lightingShader.setMat4("projection", projection);
 
         // camera/view transformation
         //glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 view = basic_camera.createViewMatrix();
-        lightingShader.setMat4("view", view);
+
+        // projection, view and viewPos go to every shader through the FrameData block
+        FrameUniforms frameUniforms = { projection, view, camera.Position, 0.0f };
+        frameStream.bind(FRAME_BLOCK_BINDING, frameStream.write(&frameUniforms, sizeof(frameUniforms)));
+
+        // level of detail of the curved primitives follows their size on screen
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        LodContext::setFrame(view, projection, (float)framebufferHeight);
+        // objects outside the view are skipped before any of their uniforms are set
+        FrustumCulling::setFrame(projection * view);
+        renderQueue.setView(view, far);
 
         // Modelling Transformation
         glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
@@ -449,12 +531,16 @@ int main()
         scaleMatrix = glm::scale(identityMatrix, glm::vec3(scale_X, scale_Y, scale_Z));
         model = translateMatrix * rotateXMatrix * rotateYMatrix * rotateZMatrix * scaleMatrix;
         lightingShader.setMat4("model", model);
+        lightingShader.setMat3("normalMatrix", normalMatrix(model));
+        scene.setLocal(classroomNodes.modelling, model);
+        //spinFan(scene, classroomNodes.fans[0], fanOn1, r1);
+        scene.update();
 
-        //glBindVertexArray(cubeVAO);
-        //glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+        //cubeMesh->draw();
         //glDrawArrays(GL_TRIANGLES, 0, 36);
 
-        classroom(cubeVAO, lightingShader, model);
+        classroomScenery.draw(lightingShader);
+        classroom(lightingShader, scene, classroomNodes, ghostParts);
 
         //bed(cubeVAO, lightingShader, model);
         //glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix;
@@ -463,28 +549,15 @@ int main()
         //glm::mat4 modelForSphere = glm::mat4(1.0f);
         
         //glm::mat4 modelForSphere = glm::mat4(1.0f);
-        translateMatrix = glm::translate(model, glm::vec3(-3.68f, 0.95f, -3.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.20f, 0.20f, 0.20f));
-        
-        globe.drawSphere(lightingShader, scaleMatrix);
-
-        //glm::mat4 modelForCylinder = glm::mat4(1.0f);
-        translateMatrix = glm::translate(model, glm::vec3(-3.68f, 0.7f, -3.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.25f, 0.25f, 0.25f));
+        globe.drawSphere(lightingShader, scene.world(classroomNodes.globe));
 
-        handle.drawCylinder(lightingShader, translateMatrix);
+        handle.drawCylinder(lightingShader, scene.world(classroomNodes.globeHandle));
 
         //cylinder
-        translateMatrix = glm::translate(model, glm::vec3(-1.80f, 0.1f, -1.8f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.55f, 0.55f, 0.55f));
-
-        cylinder.drawCylinder(lightingShader, scaleMatrix);
+        cylinder.drawCylinder(lightingShader, scene.world(classroomNodes.cylinder));
 
         //hemisphere
-        translateMatrix = glm::translate(model, glm::vec3(0.0f, -0.5f, -1.0f));
-        scaleMatrix = glm::scale(translateMatrix, glm::vec3(0.75f, 0.75f, 0.75f));
-
-        hemi.drawHemiSphere(lightingShader, scaleMatrix);
+        hemi.drawHemiSphere(lightingShader, scene.world(classroomNodes.hemisphere));
 
 
 
@@ -500,28 +573,50 @@ int main()
 
         //cylinder.drawCylinder(lightingShader, translateMatrix);
 
-        
+        // every cube drawCube() collected this frame, in a single instanced draw
+        cubeInstances.flush(lightingShader);
+        renderQueue.flush();
 
         
 
         // also draw the lamp object(s)
         ourShader.use();
-        ourShader.setMat4("projection", projection);
-        ourShader.setMat4("view", view);
 
         // we now draw as many light bulbs as we have point lights.
-        glBindVertexArray(lightCubeVAO);
+        // the light cubes reuse the cube mesh, vertexShader.vs only reads the position attribute
         for (unsigned int i = 0; i < 2; i++)
         {
             model = glm::mat4(1.0f);
             model = glm::translate(model, pointLightPositions[i]);
             model = glm::scale(model, glm::vec3(0.2f)); // Make it a smaller cube
+            if (!FrustumCulling::isVisible(cubeMesh->getBounds(), model))
+                continue;
             ourShader.setMat4("model", model);
             ourShader.setVec3("color", glm::vec3(0.8f, 0.8f, 0.8f));
-            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+            cubeMesh->draw();
             //glDrawArrays(GL_TRIANGLES, 0, 36);
         }
 
+        frameStream.endFrame();
+        cubeInstances.endFrame();
+        renderQueue.endFrame();
+        GLTrace::endFrame();
+        // with --trace-gl, the startup meshes and how the first frame was culled and batched,
+        // next to the trace's own summary
+        if (traceGL && firstFrame)
+        {
+            const CullStats& culling = FrustumCulling::getStats();
+            std::cout << "frustum culling: " << culling.culled << " of " << culling.tested() << " objects culled" << std::endl;
+            const VertexCacheSummary& vertexCache = VertexCacheSummary::current();
+            std::cout << "vertex cache: " << vertexCache.meshes << " meshes generated, " << vertexCache.triangles << " triangles, ACMR "
+                << vertexCache.acmrBefore() << " -> " << vertexCache.acmrAfter() << std::endl;
+            const RenderQueueStats& queue = renderQueue.getStats();
+            std::cout << "render queue: " << queue.draws << " draws in " << queue.drawCalls << " calls"
+                << (renderQueue.isIndirect() ? " (multi-draw indirect), " : ", ") << queue.stateChanges()
+                << " state changes (" << queue.unsortedChanges << " in submission order)" << std::endl;
+        }
+        firstFrame = false;
+
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
@@ -530,10 +625,34 @@ int main()
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightCubeVAO);
-    glDeleteBuffers(1, &cubeVBO);
-    glDeleteBuffers(1, &cubeEBO);
+    if (!assetsLoaded || assets.hasMisses())
+    {
+        AssetPackWriter writer;
+        MeshCache::exportTo(writer);
+        if (assetsLoaded)
+            writer.addMeshesFrom(assets);
+        for (const char* path : shaderPaths)
+            writer.addShaderFile(path);
+        // the old pack is still mapped, let go of it before the file is replaced
+        AssetPack::setCurrent(nullptr);
+        assets.close();
+        writer.write(ASSET_PACK_PATH);
+    }
+    AssetPack::setCurrent(nullptr);
+    RenderQueue::setCurrent(nullptr);
+    MaterialTable::setCurrent(nullptr);
+
+    // every registered mesh (cube and cached primitives) must go while the context is still alive
+    Mesh::releaseAll();
+    MeshCache::clear();
+    GeometryPool::releaseAll();
+    frameStream.release();
+    lightBlock.release();
+    materialTable.release();
+    cubeInstances.release();
+    renderQueue.release();
+    classroomScenery.release();
+    delete indirectShader;
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -541,36 +660,47 @@ int main()
     return 0;
 }
 
-void drawCube(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f,float a=1.0f)
+// baked into staticBake while it is set, else drawn with the rest of the frame's
+// cubes by cubeBatch->flush()
+void addCube(const glm::mat4& model, const glm::vec3& color, const glm::vec3& specular)
 {
-    lightingShader.use();
-
-    lightingShader.setVec3("material.ambient", glm::vec4(r,g,b,a));
-    lightingShader.setVec3("material.diffuse", glm::vec4(r, g, b, a));
-    lightingShader.setVec3("material.specular", glm::vec3(0.1,0.1,0.1));
-    lightingShader.setFloat("material.shininess", 32.0f);
-
-    lightingShader.setMat4("model", model);
-
-    glBindVertexArray(cubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    if (staticBake != nullptr)
+    {
+        MaterialState material;
+        material.ambient = material.diffuse = color;
+        material.specular = specular;
+        material.shininess = 32.0f;
+        staticBake->add(*cubeMesh, model, material);
+        return;
+    }
+    cubeBatch->add(model, color, specular, 32.0f);
 }
-void drawCube2(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f, float a = 1.0f, float e_r = 0.0f, float e_g = 0.0f, float e_b = 0.0f)
+// the cube mesh, program and alpha are the batch's; the parameters stay for the callers
+void drawCube(unsigned int& /*cubeVAO*/, Shader& /*lightingShader*/, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f,float /*a*/=1.0f)
 {
-    lightingShader.use();
-
-    lightingShader.setVec3("material.ambient", glm::vec4(r, g, b, a));
-    lightingShader.setVec3("material.diffuse", glm::vec4(r, g, b, a));
-    lightingShader.setVec3("material.specular", glm::vec3(0, 0, 0));
-    lightingShader.setFloat("material.shininess", 32.0f);
+    addCube(model, glm::vec3(r, g, b), glm::vec3(0.1f, 0.1f, 0.1f));
+}
+void drawCube2(unsigned int& /*cubeVAO*/, Shader& /*lightingShader*/, glm::mat4 model = glm::mat4(1.0f), float r = 1.0f, float g = 1.0f, float b = 1.0f, float /*a*/ = 1.0f, float /*e_r*/ = 0.0f, float /*e_g*/ = 0.0f, float /*e_b*/ = 0.0f)
+{
+    addCube(model, glm::vec3(r, g, b), glm::vec3(0.0f, 0.0f, 0.0f));
+}
 
-    lightingShader.setMat4("model", model);
+// adds the node of one cube of a piece of furniture, the cube takes its world matrix
+SceneNode addSceneCube(SceneGraph& scene, SceneNode parent, const glm::mat4& local, const glm::vec3& color, vector<SceneCube>& cubes)
+{
+    SceneNode node = scene.add(local, parent);
+    cubes.push_back({ node, color });
+    return node;
+}
 
-    glBindVertexArray(cubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+// every cube at the cached world matrix of its node, through drawCube()
+void drawSceneCubes(unsigned int& cubeVAO, Shader& lightingShader, const SceneGraph& scene, const vector<SceneCube>& cubes)
+{
+    for (const SceneCube& cube : cubes)
+        drawCube(cubeVAO, lightingShader, scene.world(cube.node), cube.color.x, cube.color.y, cube.color.z, 1.0f);
 }
 
-void bed(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 alTogether)
+void addBed(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes)
 {
     float baseHeight = 0.3;
     float width = 1;
@@ -581,70 +711,39 @@ void bed(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 alTogether)
     float blanketLength = 0.7;
     float headHeight = 0.6;
 
+    glm::mat4 identityMatrix = glm::mat4(1.0f);
+    // every part is a unit cube moved to its corner, scaled, then placed on the bed
+    glm::mat4 corner = glm::translate(identityMatrix, glm::vec3(-0.5, 0, -0.5));
+    glm::mat4 translate2, scale;
+
     //base
-    glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 translate = glm::mat4(1.0f);
-    glm::mat4 translate2 = glm::mat4(1.0f);
-    glm::mat4 scale = glm::mat4(1.0f);
-    scale = glm::scale(model, glm::vec3(width, baseHeight, length));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 0.545, 0.271, 0.075);
+    scale = glm::scale(identityMatrix, glm::vec3(width, baseHeight, length));
+    addSceneCube(scene, parent, scale * corner, glm::vec3(0.545, 0.271, 0.075), cubes);
 
     //foam
-    model = glm::mat4(1.0f);
-    translate = glm::mat4(1.0f);
-    translate2 = glm::mat4(1.0f);
-    scale = glm::mat4(1.0f);
-    translate2 = glm::translate(model, glm::vec3(0, baseHeight, 0));
-    scale = glm::scale(model, glm::vec3(width, 0.06, length));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * translate2 * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 0.804, 0.361, 0.361);
+    translate2 = glm::translate(identityMatrix, glm::vec3(0, baseHeight, 0));
+    scale = glm::scale(identityMatrix, glm::vec3(width, 0.06, length));
+    addSceneCube(scene, parent, translate2 * scale * corner, glm::vec3(0.804, 0.361, 0.361), cubes);
 
     //pillow 1
-    model = glm::mat4(1.0f);
-    translate = glm::mat4(1.0f);
-    translate2 = glm::mat4(1.0f);
-    scale = glm::mat4(1.0f);
-    translate2 = glm::translate(model, glm::vec3((width / 2) - (0.1 + pillowWidth / 2), baseHeight + 1 * 0.06, (length / 2) - (0.025 + pillowWidth / 2)));
-    scale = glm::scale(model, glm::vec3(pillowWidth, 0.04, pillowLength));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * translate2 * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 1, 0.647, 0);
+    translate2 = glm::translate(identityMatrix, glm::vec3((width / 2) - (0.1 + pillowWidth / 2), baseHeight + 1 * 0.06, (length / 2) - (0.025 + pillowWidth / 2)));
+    scale = glm::scale(identityMatrix, glm::vec3(pillowWidth, 0.04, pillowLength));
+    addSceneCube(scene, parent, translate2 * scale * corner, glm::vec3(1, 0.647, 0), cubes);
 
     //pillow 2
-    model = glm::mat4(1.0f);
-    translate = glm::mat4(1.0f);
-    translate2 = glm::mat4(1.0f);
-    scale = glm::mat4(1.0f);
-    translate2 = glm::translate(model, glm::vec3((-width / 2) + (0.1 + pillowWidth / 2), baseHeight + 1 * 0.06, (length / 2) - (0.025 + pillowWidth / 2)));
-    scale = glm::scale(model, glm::vec3(pillowWidth, 0.04, pillowLength));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * translate2 * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 1, 0.647, 0);
+    translate2 = glm::translate(identityMatrix, glm::vec3((-width / 2) + (0.1 + pillowWidth / 2), baseHeight + 1 * 0.06, (length / 2) - (0.025 + pillowWidth / 2)));
+    scale = glm::scale(identityMatrix, glm::vec3(pillowWidth, 0.04, pillowLength));
+    addSceneCube(scene, parent, translate2 * scale * corner, glm::vec3(1, 0.647, 0), cubes);
 
     //blanket
-    model = glm::mat4(1.0f);
-    translate = glm::mat4(1.0f);
-    translate2 = glm::mat4(1.0f);
-    scale = glm::mat4(1.0f);
-    translate2 = glm::translate(model, glm::vec3(0, baseHeight + 1 * 0.06, -(length / 2 - 0.025) + blanketLength / 2));
-    scale = glm::scale(model, glm::vec3(blanketWidth, 0.015, blanketLength));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * translate2 * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 0.541, 0.169, 0.886);
+    translate2 = glm::translate(identityMatrix, glm::vec3(0, baseHeight + 1 * 0.06, -(length / 2 - 0.025) + blanketLength / 2));
+    scale = glm::scale(identityMatrix, glm::vec3(blanketWidth, 0.015, blanketLength));
+    addSceneCube(scene, parent, translate2 * scale * corner, glm::vec3(0.541, 0.169, 0.886), cubes);
 
     //head
-    model = glm::mat4(1.0f);
-    translate = glm::mat4(1.0f);
-    translate2 = glm::mat4(1.0f);
-    scale = glm::mat4(1.0f);
-    translate2 = glm::translate(model, glm::vec3(0, 0, (length / 2 - 0.02 / 2) + 0.02));
-    scale = glm::scale(model, glm::vec3(width, headHeight, 0.02));
-    translate = glm::translate(model, glm::vec3(-0.5, 0, -0.5));
-    model = alTogether * translate2 * scale * translate;
-    drawCube(cubeVAO, lightingShader, model, 0.545, 0.271, 0.075);
+    translate2 = glm::translate(identityMatrix, glm::vec3(0, 0, (length / 2 - 0.02 / 2) + 0.02));
+    scale = glm::scale(identityMatrix, glm::vec3(width, headHeight, 0.02));
+    addSceneCube(scene, parent, translate2 * scale * corner, glm::vec3(0.545, 0.271, 0.075), cubes);
 
 }
 
@@ -917,139 +1016,57 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
-void drawTabChairBook(Shader& shaderProgram, unsigned int VAO, glm::mat4 parentTrans)
+void addTabChairBook(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes)
 {
-    shaderProgram.use();
     glm::mat4 identityMatrix = glm::mat4(1.0f);
-    glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix, model, modelCentered;
-
-    //translateMatrix = glm::translate(parentTrans, glm::vec3(posX, posY, posZ));
-    //rotateXMatrix = glm::rotate(translateMatrix, glm::radians(rotX), glm::vec3(1.0f, 0.0f, 0.0f));
-    //rotateYMatrix = glm::rotate(rotateXMatrix, glm::radians(rotY), glm::vec3(0.0f, 1.0f, 0.0f));
-    //rotateZMatrix = glm::rotate(rotateYMatrix, glm::radians(rotZ), glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::mat4 translateMatrix;
+    const glm::vec3 tableColor(0.9176f, 0.7020f, 0.0314f);
+    const glm::vec3 chairColor(0.3f, 0.2f, 0.1f);
 
     //table 
-    model = parentTrans * glm::scale(identityMatrix, glm::vec3(3.5f, 0.2f, 2.0f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.9176f, 0.7020f, 0.0314f);
-    //drawCube(VAO, shaderProgram, model, 1.0f, 0.0f, 0.0f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(0.9176f, 0.7020f, 0.0314f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, glm::scale(identityMatrix, glm::vec3(3.5f, 0.2f, 2.0f)), tableColor, cubes);
     //table er pa
-    model = parentTrans * glm::scale(identityMatrix, glm::vec3(0.2f, -2.0f, 0.2f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.9176f, 0.7020f, 0.0314f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(0.9176f, 0.7020f, 0.0314f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
+    addSceneCube(scene, parent, glm::scale(identityMatrix, glm::vec3(0.2f, -2.0f, 0.2f)), tableColor, cubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0, 0.0, 0.9));
-    model = parentTrans * glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.9176f, 0.7020f, 0.0314f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(0.9176f, 0.7020f, 0.0314f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f)), tableColor, cubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(1.65, 0.0, 0.9));
-    model = parentTrans * glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.9176f, 0.7020f, 0.0314f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(0.9176f, 0.7020f, 0.0314f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f)), tableColor, cubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(1.65, 0.0, 0.0));
-    model = parentTrans * glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.9176f, 0.7020f, 0.0314f);
-   // shaderProgram.setMat4("model", model);
-   // shaderProgram.setVec4("color", glm::vec4(0.9176f, 0.7020f, 0.0314f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
+    addSceneCube(scene, parent, glm::scale(translateMatrix, glm::vec3(0.2f, -2.0f, 0.2f)), tableColor, cubes);
 
     //lower book
     translateMatrix = glm::translate(identityMatrix, glm::vec3(0.55f, 0.1f, 0.50f));
-    model = parentTrans * glm::scale(translateMatrix, glm::vec3(1.0f, 0.1f, 1.0f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 0.0f, 0.0f, 0.0f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(0.0f, 0.0f, 0.0f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, glm::scale(translateMatrix, glm::vec3(1.0f, 0.1f, 1.0f)), glm::vec3(0.0f, 0.0f, 0.0f), cubes);
 
     //upper book
     translateMatrix = glm::translate(identityMatrix, glm::vec3(0.67f, 0.15f, 0.75f));
-    model = parentTrans * glm::scale(translateMatrix, glm::vec3(0.5f, 0.1f, 0.50f));
-    //modelCentered = glm::translate(model, glm::vec3(-0.25, -0.25, -0.25));
-    drawCube(VAO, shaderProgram, model, 1.0f, 1.0f, 1.0f);
-    //shaderProgram.setMat4("model", model);
-    //shaderProgram.setVec4("color", glm::vec4(1.0f, 1.0f, 1.0f, 0.89f));
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, glm::scale(translateMatrix, glm::vec3(0.5f, 0.1f, 0.50f)), glm::vec3(1.0f, 1.0f, 1.0f), cubes);
+
+    // the chair, in front of the books; its parts hang from the chair node
+    SceneNode chair = scene.add(glm::translate(identityMatrix, glm::vec3(0.5f, -0.5f, 0.6f)), parent);
 
     // Chair Seat
-    glm::mat4 chairSeatTranslate = glm::translate(identityMatrix, glm::vec3(0.5f, -0.5f, 0.6f)); // Position in front of the books
-    glm::mat4 chairSeat = parentTrans * glm::scale(chairSeatTranslate, glm::vec3(1.2f, 0.2f, 1.0f)); // Proper seat size
-    drawCube(VAO, shaderProgram, chairSeat, 0.5f, 0.25f, 0.0f);
-    //shaderProgram.setMat4("model", chairSeat);
-    //shaderProgram.setVec4("color", glm::vec4(0.5f, 0.25f, 0.0f, 1.0f)); // Brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, chair, glm::scale(identityMatrix, glm::vec3(1.2f, 0.2f, 1.0f)), glm::vec3(0.5f, 0.25f, 0.0f), cubes);
 
     // Chair Backrest
-    glm::mat4 chairBackrestTranslate = glm::translate(chairSeatTranslate, glm::vec3(0.0f, 0.1f, 0.4f)); // Position backrest behind the seat
-    glm::mat4 chairBackrest = parentTrans * glm::scale(chairBackrestTranslate, glm::vec3(1.2f, 1.4f, 0.2f)); // Backrest size
-    drawCube(VAO, shaderProgram, chairBackrest, 0.3f, 0.2f, 0.1f);
-    //shaderProgram.setMat4("model", chairBackrest);
-    //shaderProgram.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f)); // Brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Chair Leg 1
-    glm::mat4 leg1Translate = glm::translate(chairSeatTranslate, glm::vec3(0.0f, -0.50f, 0.4f)); // Bottom-left leg
-    glm::mat4 chairLeg1 = parentTrans * glm::scale(leg1Translate, glm::vec3(0.2f, 1.0f, 0.2f)); // Leg size
-    drawCube(VAO, shaderProgram, chairLeg1, 0.3f, 0.2f, 0.1f);
-    //shaderProgram.setMat4("model", chairLeg1);
-    //shaderProgram.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f)); // Dark brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Chair Leg 2
-    glm::mat4 leg2Translate = glm::translate(chairSeatTranslate, glm::vec3(0.5f, -0.50f, 0.4f)); // Bottom-right leg
-    glm::mat4 chairLeg2 = parentTrans * glm::scale(leg2Translate, glm::vec3(0.2f, 1.0f, 0.2f)); // Leg size
-    drawCube(VAO, shaderProgram, chairLeg2, 0.3f, 0.2f, 0.1f);
-    //shaderProgram.setMat4("model", chairLeg2);
-    //shaderProgram.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f)); // Dark brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Chair Leg 3
-    glm::mat4 leg3Translate = glm::translate(chairSeatTranslate, glm::vec3(0.5f, -0.50f, 0.0f)); // Bottom-right leg
-    glm::mat4 chairLeg3 = parentTrans * glm::scale(leg3Translate, glm::vec3(0.2f, 1.0f, 0.2f)); // Leg size
-    drawCube(VAO, shaderProgram, chairLeg3, 0.3f, 0.2f, 0.1f);
-    //shaderProgram.setMat4("model", chairLeg3);
-    //shaderProgram.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f)); // Dark brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Chair Leg 4
-    glm::mat4 leg4Translate = glm::translate(chairSeatTranslate, glm::vec3(0.0f, -0.50f, 0.0f)); // Bottom-right leg
-    glm::mat4 chairLeg4 = parentTrans * glm::scale(leg4Translate, glm::vec3(0.2f, 1.0f, 0.2f)); // Leg size
-    drawCube(VAO, shaderProgram, chairLeg4, 0.3f, 0.2f, 0.1f);
-    //shaderProgram.setMat4("model", chairLeg4);
-    //shaderProgram.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f)); // Dark brown color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, 0.1f, 0.4f)); // behind the seat
+    addSceneCube(scene, chair, glm::scale(translateMatrix, glm::vec3(1.2f, 1.4f, 0.2f)), chairColor, cubes);
+
+    // Chair Legs
+    const glm::vec3 legPositions[] = {
+        glm::vec3(0.0f, -0.50f, 0.4f),      // bottom-left
+        glm::vec3(0.5f, -0.50f, 0.4f),      // bottom-right
+        glm::vec3(0.5f, -0.50f, 0.0f),
+        glm::vec3(0.0f, -0.50f, 0.0f)
+    };
+    for (const glm::vec3& position : legPositions)
+    {
+        translateMatrix = glm::translate(identityMatrix, position);
+        addSceneCube(scene, chair, glm::scale(translateMatrix, glm::vec3(0.2f, 1.0f, 0.2f)), chairColor, cubes);
+    }
 }
 // Function to draw walls and floor with red carpet
 void drawWallsAndFloorWithCarpet(Shader& shaderProgram, unsigned int VAO, glm::mat4 model) {
@@ -1060,16 +1077,12 @@ void drawWallsAndFloorWithCarpet(Shader& shaderProgram, unsigned int VAO, glm::m
     floorTransform = glm::scale(floorTransform, glm::vec3(11.0f, 0.1f, 9.5f)); // Large floor
     floorTransform = floorTransform * model;
     drawCube(VAO, shaderProgram, floorTransform, 0.6353f, 0.0314f, 0.1373f); // Floor color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Front Wall (with a door gap)
     glm::mat4 frontWallTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, -.51f, -3.7f));
     frontWallTransform = glm::scale(frontWallTransform, glm::vec3(11.0f, 5.0f, 0.1f));
     frontWallTransform = frontWallTransform * model;
     drawCube(VAO, shaderProgram, frontWallTransform, 0.6f, 0.3f, 0.1f); // Wall color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
    
 
@@ -1078,40 +1091,31 @@ void drawWallsAndFloorWithCarpet(Shader& shaderProgram, unsigned int VAO, glm::m
     backWallTransform = glm::scale(backWallTransform, glm::vec3(11.0f, 5.0f, 0.1f));
     backWallTransform = backWallTransform * model;
     drawCube(VAO, shaderProgram, backWallTransform, 0.9f, 0.9f, 0.9f);
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);*/
+    cubeMesh->draw();*/
 
     // Left Wall
     glm::mat4 leftWallTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, -.51f, -3.7f));
     leftWallTransform = glm::scale(leftWallTransform, glm::vec3(0.1f, 5.0f, 9.5f));
     leftWallTransform = leftWallTransform * model;
     drawCube(VAO, shaderProgram, leftWallTransform, 0.6f, 0.3f, 0.1f);
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Right Wall (Positioned at middle)
     glm::mat4 rightWallTransform = glm::translate(identityMatrix, glm::vec3(1.5f, -.51f, -3.7f)); // Position of the right wall
     rightWallTransform = glm::scale(rightWallTransform, glm::vec3(0.1f, 5.0f, 9.5f)); // Wall dimensions
     rightWallTransform = rightWallTransform * model;
     drawCube(VAO, shaderProgram, rightWallTransform, 0.6f, 0.3f, 0.1f); // Wall color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Creating a gap for the door at the middle of the right wall
     glm::mat4 doorTransform = glm::translate(identityMatrix, glm::vec3(1.5f, -0.5f, -1.6f)); // Middle of the wall on x and z axis
     doorTransform = glm::scale(doorTransform, glm::vec3(0.1f, 4.0f, 2.0f)); // Door gap size (2 units wide, 4 units tall, thin depth)
     doorTransform = doorTransform * model;
     drawCube(VAO, shaderProgram, doorTransform, 0.0f, 0.0f, 0.0f); // Black to simulate "subtraction"
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Actual Door (Placed slightly inside the gap)
     glm::mat4 actualDoorTransform = glm::translate(identityMatrix, glm::vec3(1.45f, -0.5f, -1.6f)); // Slightly inside the gap on the z-axis
     actualDoorTransform = glm::scale(actualDoorTransform, glm::vec3(0.1f, 4.0f, 2.0f)); // Door dimensions
     drawCube(VAO, shaderProgram, actualDoorTransform, 0.5f, 0.3f, 0.1f); // Wooden door color
     actualDoorTransform = actualDoorTransform * model;
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     
 
@@ -1121,16 +1125,12 @@ void drawWallsAndFloorWithCarpet(Shader& shaderProgram, unsigned int VAO, glm::m
     windowTransform = glm::scale(windowTransform, glm::vec3(3.0f, 2.5f, 0.1f)); // Window size
     drawCube(VAO, shaderProgram, windowTransform, 0.0f, 0.0f, 0.0f); // Simulating subtraction for window gap
     windowTransform = windowTransform * model;
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Adding transparent glass inside the window
     glm::mat4 glassTransform = glm::translate(identityMatrix, glm::vec3(-2.0f, 0.40f, -3.6f)); // Slightly inside position for glass
     glassTransform = glm::scale(glassTransform, glm::vec3(2.8f, 2.3f, 0.05f)); // Thin glass for the window
     glassTransform = glassTransform * model;
     drawCube(VAO, shaderProgram, glassTransform, 0.5f, 0.7f, 1.0f, 0.5f); // Light blue transparent glass (RGBA with alpha)
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
     
 }
 void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
@@ -1142,8 +1142,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, floorTransform, 0.6353f, 0.0314f, 0.1373f);
     //shaderProgram.setMat4("model", floorTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.6353f, 0.0314f, 0.1373f, 0.8f)); // Light gray floor
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Front Wall
     glm::mat4 frontWallTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, -.51f, -3.7f)); // Positioned along Z-axis
@@ -1151,8 +1149,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, floorTransform, 0.9f, 0.9f, 0.9f);
     //shaderProgram.setMat4("model", frontWallTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.9f, 0.9f, 0.9f, 1.0f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Back Wall
     glm::mat4 backWallTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, -.51f, 1.0f)); // Positioned along Z-axis
@@ -1160,8 +1156,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, backWallTransform, 0.9f, 0.9f, 0.9f);
     //shaderProgram.setMat4("model", backWallTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.9f, 0.9f, 0.9f, 1.0f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Left Wall
     glm::mat4 leftWallTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, -.51f, -3.7f)); // Positioned along X-axis
@@ -1169,8 +1163,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, leftWallTransform, 0.9f, 0.9f, 0.9f);
     //shaderProgram.setMat4("model", leftWallTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.9f, 0.9f, 0.9f, 1.0f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     //AC1
     glm::mat4 acTransform = glm::translate(identityMatrix, glm::vec3(-4.0f, 0.4f, -2.0f)); // Positioned along X-axis
@@ -1178,8 +1170,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, acTransform, 0.9647f, 0.8235f, 0.3725f);
     //shaderProgram.setMat4("model", acTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.9647f, 0.8235f, 0.3725f, 0.8f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     //AC2
     glm::mat4 acTransform2 = glm::translate(identityMatrix, glm::vec3(-4.0f, 0.4f, -0.4f)); // Positioned along X-axis
@@ -1187,8 +1177,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, acTransform2, 0.9647f, 0.8235f, 0.3725f);
     //shaderProgram.setMat4("model", acTransform2);
     //shaderProgram.setVec4("color", glm::vec4(0.9647f, 0.8235f, 0.3725f, 0.8f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     // Right Wall
     glm::mat4 rightWallTransform = glm::translate(identityMatrix, glm::vec3(1.5f, -.51f, -3.7f)); // Positioned along X-axis
@@ -1196,8 +1184,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, rightWallTransform, 0.9f, 0.9f, 0.9f);
     //shaderProgram.setMat4("model", rightWallTransform);
     //shaderProgram.setVec4("color", glm::vec4(0.9f, 0.9f, 0.9f, 1.0f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     //AC3
     glm::mat4 acTransform3 = glm::translate(identityMatrix, glm::vec3(1.1f, 0.4f, -2.0f)); // Positioned along X-axis
@@ -1205,8 +1191,6 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, acTransform3, 0.9647f, 0.8235f, 0.3725f);
     //saderProgram.setMat4("model", acTransform3);
    // shaderProgram.setVec4("color", glm::vec4(0.9647f, 0.8235f, 0.3725f, 0.8f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
     //AC4
     glm::mat4 acTransform4 = glm::translate(identityMatrix, glm::vec3(1.1f, 0.4f, -0.4f)); // Positioned along X-axis
@@ -1214,159 +1198,79 @@ void drawWallsAndFloorWithCarpet2(Shader& shaderProgram, unsigned int VAO) {
     drawCube(VAO, shaderProgram, acTransform4, 0.9647f, 0.8235f, 0.3725f);
     //shaderProgram.setMat4("model", acTransform4);
     //shaderProgram.setVec4("color", glm::vec4(0.9647f, 0.8235f, 0.3725f, 0.8f)); // Off-white color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 }
 
-void drawFan(Shader& shaderProgram, unsigned int VAO, glm::mat4 parentTrans, bool fanOn, float& r) {
+FanNodes addFan(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes) {
     glm::mat4 identityMatrix = glm::mat4(1.0f);
-    glm::mat4 translateMatrix, translateMatrix2, translateMatrix3, scaleMatrix, model;
-
-    if (fanOn) {
-        // Blade 1
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 0.5f, 0.125f));
-        translateMatrix2 = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.5f, -0.125f));
-        translateMatrix3 = glm::translate(parentTrans, glm::vec3(-1.5f, 0.0f, -1.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(2.0f, 0.1f, 0.5f));
-        model = translateMatrix3 * translateMatrix * glm::rotate(identityMatrix, glm::radians(r), glm::vec3(0.0f, 1.0f, 0.0f)) * translateMatrix2 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.1451f, 0.2039f, 0.5725f);
-        //shaderProgram.setMat4("model", model);
-        //shaderProgram.setVec4("color", glm::vec4(0.1451f, 0.2039f, 0.5725f, 0.8f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Blade 2
-        model = translateMatrix3 * translateMatrix * glm::rotate(identityMatrix, glm::radians(r + 90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * translateMatrix2 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.1451f, 0.2039f, 0.5725f);
-        //shaderProgram.setMat4("model", model);
-        //shaderProgram.setVec4("color", glm::vec4(0.1451f, 0.2039f, 0.5725f, 0.8f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Stand
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.1f, 0.6f, 0.1f));
-        translateMatrix3 = glm::translate(parentTrans, glm::vec3(-1.02f, 1.0f, -1.58f));
-        model = translateMatrix3 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.0, 0.0f, 0.0f);
-       // shaderProgram.setMat4("model", model);
-       // shaderProgram.setVec4("color", glm::vec4(0.0, 0.0f, 0.0f, 1.0f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Update rotation
-        r = (r + 5.0f);
-    }
-    else {
-        // Blade 1 (Static)
-        translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 0.5f, 0.125f));
-        translateMatrix2 = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.5f, -0.125f));
-        translateMatrix3 = glm::translate(parentTrans, glm::vec3(-1.5f, 0.0f, -1.7f));
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(2.0f, 0.1f, 0.5f));
-        model = translateMatrix3 * translateMatrix * glm::rotate(identityMatrix, glm::radians(r), glm::vec3(0.0f, 1.0f, 0.0f)) * translateMatrix2 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.1451f, 0.2039f, 0.5725f);
-        //shaderProgram.setMat4("model", model);
-        //shaderProgram.setVec4("color", glm::vec4(0.1451f, 0.2039f, 0.5725f, 0.8f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Blade 2 (Static)
-        model = translateMatrix3 * translateMatrix * glm::rotate(identityMatrix, glm::radians(r + 90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * translateMatrix2 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.1451f, 0.2039f, 0.5725f);
-        //shaderProgram.setMat4("model", model);
-        //shaderProgram.setVec4("color", glm::vec4(0.1451f, 0.2039f, 0.5725f, 0.8f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Stand
-        scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.1f, 0.6f, 0.1f));
-        translateMatrix3 = glm::translate(parentTrans, glm::vec3(-1.02f, 1.0f, -1.58f));
-        model = translateMatrix3 * scaleMatrix;
-        drawCube(VAO, shaderProgram, model, 0.0, 0.0f, 0.0f);
-        //shaderProgram.setMat4("model", model);
-        //shaderProgram.setVec4("color", glm::vec4(0.0, 0.0f, 0.0f, 1.0f));
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    FanNodes fan;
+
+    // the blades turn about the hub, spinFan() only rewrites their local transforms
+    fan.hub = scene.add(glm::translate(identityMatrix, glm::vec3(-1.5f, 0.0f, -1.7f)), parent);
+    for (int i = 0; i < 2; ++i)
+    {
+        fan.blades[i] = scene.add(fanBladeTransform(i * 90.0f), fan.hub);
+        cubes.push_back({ fan.blades[i], glm::vec3(0.1451f, 0.2039f, 0.5725f) });
     }
-}
 
-// Function to draw a ghost sculpture
-// Function to draw a ghost sculpture
-// Function to draw a ghost sculpture
-void drawGhostSculpture(Shader& shaderProgram, unsigned int VAO, glm::mat4 model) {
-    glm::mat4 identityMatrix = glm::mat4(1.0f);
+    // Stand
+    glm::mat4 standTransform = glm::translate(identityMatrix, glm::vec3(-1.02f, 1.0f, -1.58f)) * glm::scale(identityMatrix, glm::vec3(0.1f, 0.6f, 0.1f));
+    fan.stand = addSceneCube(scene, parent, standTransform, glm::vec3(0.0, 0.0f, 0.0f), cubes);
+    return fan;
+}
 
-    // Create a sphere (Body of the ghost)
-    Hemisphere ghostBody(1.0f, 36, 18, glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.1f, 0.1f, 0.3f), 2.0f);                      // shininess
-          // emissive color (this makes it glow)
-   
-    glm::mat4 bodyTransform = glm::translate(identityMatrix, glm::vec3(0.7f, 0.5f, -2.0f)); // Positioning the ghost's body
-    bodyTransform = glm::scale(bodyTransform, glm::vec3(1.0f, 1.5f, 1.0f)); // Scaling to form an oval
-    bodyTransform = bodyTransform * model; // Apply model transformations (translation and scaling)
-    ghostBody.drawHemiSphere(shaderProgram, bodyTransform); // Draw the sphere as the ghost's body
+// a stopped fan leaves its blades alone, so they are not recomputed
+void spinFan(SceneGraph& scene, const FanNodes& fan, bool fanOn, float& r) {
+    scene.setLocal(fan.blades[0], fanBladeTransform(r));
+    scene.setLocal(fan.blades[1], fanBladeTransform(r + 90.0f));
 
-    // Create a cone (Lower part of the ghost)
-    Cone ghostTail(1.0f, 2.0f, 36, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), 32.0f); // Light purple color
-    glm::mat4 tailTransform = glm::translate(identityMatrix, glm::vec3(0.7f, 0.5f, -2.0f)); // Position beneath the body
-    tailTransform = glm::scale(tailTransform, glm::vec3(1.0f, 1.0f, 1.0f)); // Making the cone wider
-    tailTransform = glm::rotate(tailTransform, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // Flip the cone upside down
-    tailTransform = tailTransform * model; // Apply model transformations
-    ghostTail.drawCone(shaderProgram, tailTransform); // Draw the cone as the ghost's tail
-
-    // Adding transparency to the ghost
-    shaderProgram.use();
-    shaderProgram.setFloat("material.transparency", 0.3f); // Adjust transparency level (0.0 - 1.0)
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Enable alpha blending
+    // Update rotation
+    if (fanOn)
+        r = (r + 5.0f);
 }
 
-void drawGhostSculpture2(Shader& shaderProgram, unsigned int VAO, glm::mat4 model) {
+// blade turned by angle degrees about the hub
+glm::mat4 fanBladeTransform(float angle) {
     glm::mat4 identityMatrix = glm::mat4(1.0f);
+    glm::mat4 translateMatrix = glm::translate(identityMatrix, glm::vec3(0.5f, 0.5f, 0.125f));
+    glm::mat4 translateMatrix2 = glm::translate(identityMatrix, glm::vec3(-0.5f, 0.5f, -0.125f));
+    glm::mat4 scaleMatrix = glm::scale(identityMatrix, glm::vec3(2.0f, 0.1f, 0.5f));
+    return translateMatrix * glm::rotate(identityMatrix, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f)) * translateMatrix2 * scaleMatrix;
+}
 
-    // Create a sphere (Body of the ghost)
-    Hemisphere ghostBody(1.0f, 36, 18, glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.8f, 0.8f, 0.8f), glm::vec3(0.1f, 0.1f, 0.3f), 2.0f);                      // shininess
-    // emissive color (this makes it glow)
+// Function to add a ghost sculpture: the body and the tail, each with its own node
+GhostNodes addGhostSculpture(SceneGraph& scene, glm::vec3 position, glm::mat4 model) {
+    glm::mat4 identityMatrix = glm::mat4(1.0f);
+    GhostNodes ghost;
 
-    glm::mat4 bodyTransform = glm::translate(identityMatrix, glm::vec3(0.7f, 0.5f, 0.5f)); // Positioning the ghost's body
+    glm::mat4 bodyTransform = glm::translate(identityMatrix, position); // Positioning the ghost's body
     bodyTransform = glm::scale(bodyTransform, glm::vec3(1.0f, 1.5f, 1.0f)); // Scaling to form an oval
-    bodyTransform = bodyTransform * model; // Apply model transformations (translation and scaling)
-    ghostBody.drawHemiSphere(shaderProgram, bodyTransform); // Draw the sphere as the ghost's body
+    ghost.body = scene.add(bodyTransform * model); // Apply model transformations (translation and scaling)
 
-    // Create a cone (Lower part of the ghost)
-    Cone ghostTail(1.0f, 2.0f, 36, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), 32.0f); // Light purple color
-    glm::mat4 tailTransform = glm::translate(identityMatrix, glm::vec3(0.7f, 0.5f, 0.5f)); // Position beneath the body
-    tailTransform = glm::scale(tailTransform, glm::vec3(1.0f, 1.0f, 1.0f)); // Making the cone wider
+    glm::mat4 tailTransform = glm::translate(identityMatrix, position); // Position beneath the body
     tailTransform = glm::rotate(tailTransform, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // Flip the cone upside down
-    tailTransform = tailTransform * model; // Apply model transformations
-    ghostTail.drawCone(shaderProgram, tailTransform); // Draw the cone as the ghost's tail
-
-    // Adding transparency to the ghost
-    shaderProgram.use();
-    shaderProgram.setFloat("material.transparency", 0.3f); // Adjust transparency level (0.0 - 1.0)
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Enable alpha blending
+    ghost.tail = scene.add(tailTransform * model); // Apply model transformations
+    return ghost;
 }
 
-// Function to draw a sphere (used for the body of the ghost)
-void drawSphere(unsigned int VAO, Shader& shaderProgram, glm::mat4 model, float r, float g, float b, float alpha) {
-    shaderProgram.use();
-    shaderProgram.setMat4("model", model);
-    shaderProgram.setVec4("color", glm::vec4(r, g, b, alpha)); // Set the color and transparency
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-}
+// Function to draw a ghost sculpture
+void drawGhostSculpture(Shader& shaderProgram, const SceneGraph& scene, const GhostNodes& ghost, const GhostParts& parts) {
+    parts.body.drawHemiSphere(shaderProgram, scene.world(ghost.body)); // Draw the sphere as the ghost's body
 
-// Function to draw a cone (used for the lower part of the ghost)
-void drawCone(unsigned int VAO, Shader& shaderProgram, glm::mat4 model, float r, float g, float b, float alpha) {
+    parts.tail.drawCone(shaderProgram, scene.world(ghost.tail)); // Draw the cone as the ghost's tail
+
+    // Adding transparency to the ghost
     shaderProgram.use();
-    shaderProgram.setMat4("model", model);
-    shaderProgram.setVec4("color", glm::vec4(r, g, b, alpha)); // Set the color and transparency
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    shaderProgram.setFloat("material.transparency", 0.3f); // Adjust transparency level (0.0 - 1.0)
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Enable alpha blending
 }
 
 
 
 
 
-void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
+// the parts of the classroom that never move; drawn through drawCube(), so with
+// staticBake set they end up in the baked static geometry
+void classroomStatic(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
 {
     glm::mat4 identityMatrix = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first
     glm::mat4 translateMatrix, rotateXMatrix, rotateYMatrix, rotateZMatrix, scaleMatrix;
@@ -1381,8 +1285,6 @@ void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
         drawCube(cubeVAO, lightingShader, model, 0.5f, 0.4f, 0.2f, 1.0f);
         //ourShader.setMat4("model", model);
         //ourShader.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f));
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
         //almirah door
         translateMatrix = glm::translate(identityMatrix, glm::vec3(-3.00f, -0.5f, -1.0f));
@@ -1391,8 +1293,6 @@ void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
         drawCube(cubeVAO, lightingShader, model, 0.9f, 0.4f, 0.2f, 1.0f);
         //ourShader.setMat4("model", model);
         //ourShader.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f));
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
         
         //shinduk
@@ -1402,8 +1302,6 @@ void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
         drawCube(cubeVAO, lightingShader, model, 0.3f, 0.2f, 0.1f, 1.0f);
         //ourShader.setMat4("model", model);
         //ourShader.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f));
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
         //shinduk er upor
         translateMatrix = glm::translate(identityMatrix, glm::vec3(-1.5f, 0.1f, -3.5f));
         scaleMatrix = glm::scale(identityMatrix, glm::vec3(3.5f, 0.4f, 1.5f));
@@ -1411,123 +1309,105 @@ void classroom(unsigned int& cubeVAO, Shader& lightingShader, glm::mat4 model)
         drawCube(cubeVAO, lightingShader, model, 0.6f, 0.3f, 0.6f, 1.0f);
         //ourShader.setMat4("model", model);
         //ourShader.setVec4("color", glm::vec4(0.3f, 0.2f, 0.1f, 1.0f));
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
 
-        
+    //table, chair and books
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(-4.0f, 0.5f, -3.5f));
+    glm::mat4 mat = translateMatrix * glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
+    // baked once, so in a scene graph of its own that is updated only here
+    SceneGraph furniture;
+    vector<SceneCube> furnitureCubes;
+    addTabChairBook(furniture, furniture.add(mat), furnitureCubes);
+    furniture.update();
+    drawSceneCubes(cubeVAO, lightingShader, furniture, furnitureCubes);
+}
 
-        
+// nodes of everything the render loop draws outside the baked geometry; the local
+// transforms are set here once, the loop only updates the modelling transform
+ClassroomNodes buildClassroomScene(SceneGraph& scene)
+{
+    glm::mat4 identityMatrix = glm::mat4(1.0f);
+    glm::mat4 translateMatrix;
+    ClassroomNodes nodes;
 
-        
+    // the global translate/rotate/scale keys
+    nodes.modelling = scene.add(identityMatrix);
 
+    //sphere
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(-3.68f, 0.95f, -3.0f));
+    nodes.globe = scene.add(glm::scale(translateMatrix, glm::vec3(0.20f, 0.20f, 0.20f)), nodes.modelling);
 
-        
+    //handle of the globe, unscaled
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(-3.68f, 0.7f, -3.0f));
+    nodes.globeHandle = scene.add(translateMatrix, nodes.modelling);
 
+    //cylinder
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(-1.80f, 0.1f, -1.8f));
+    nodes.cylinder = scene.add(glm::scale(translateMatrix, glm::vec3(0.55f, 0.55f, 0.55f)), nodes.modelling);
+
+    //hemisphere
+    translateMatrix = glm::translate(identityMatrix, glm::vec3(0.0f, -0.5f, -1.0f));
+    nodes.hemisphere = scene.add(glm::scale(translateMatrix, glm::vec3(0.75f, 0.75f, 0.75f)), nodes.modelling);
 
     //fan
-    //drawFan(ourShader, VAO, identityMatrix, fanOn, r);
     /*translateMatrix = glm::translate(identityMatrix, glm::vec3(-1.2f, 0.0f, 0.2f));
-
-    drawFan(lightingShader, cubeVAO, translateMatrix, fanOn1, r1);
+    nodes.fans[0] = addFan(scene, scene.add(translateMatrix, nodes.modelling), nodes.fanCubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 0.0f, 0.2f));
-    drawFan(lightingShader, cubeVAO, translateMatrix, fanOn2, r2);
+    nodes.fans[1] = addFan(scene, scene.add(translateMatrix, nodes.modelling), nodes.fanCubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(-1.2f, 0.0f, 1.5f));
-    drawFan(lightingShader, cubeVAO, translateMatrix, fanOn3, r3);
+    nodes.fans[2] = addFan(scene, scene.add(translateMatrix, nodes.modelling), nodes.fanCubes);
 
     translateMatrix = glm::translate(identityMatrix, glm::vec3(0.9f, 0.0f, 1.5f));
-    drawFan(lightingShader, cubeVAO, translateMatrix, fanOn4, r4);*/
-
-    glm::mat4 mat = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
-    //sm = glm::translate(identityMatrix, glm::vec3(-1.2f, 0.0f, 1.4f)) * glm::rotate(identityMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
-
-    //drawTabChairBook(ourShader, VAO, sm);
-    mat = mat * model;
-
-    //mat = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
-    //drawTabChairBook(lightingShader, cubeVAO, mat);
-    translateMatrix = glm::translate(identityMatrix, glm::vec3(-4.0f, 0.5f, -3.5f));
-    mat = translateMatrix * glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
-    drawTabChairBook(lightingShader, cubeVAO, mat);
-    mat = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
-    //translateMatrix= glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -3.5f));
-
-    scaleMatrix = glm::scale(mat, glm::vec3(0.50f, 0.50f, 0.50f));
-
-    drawGhostSculpture(lightingShader, cubeVAO, scaleMatrix);
+    nodes.fans[3] = addFan(scene, scene.add(translateMatrix, nodes.modelling), nodes.fanCubes);*/
 
-    mat = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f));
-    //translateMatrix= glm::translate(identityMatrix, glm::vec3(0.0f, 0.0f, -3.5f));
-
-    scaleMatrix = glm::scale(mat, glm::vec3(0.50f, 0.50f, 0.50f));
-
-    drawGhostSculpture2(lightingShader, cubeVAO, scaleMatrix);
-
-    
+    // the ghosts are placed without the modelling transform
+    glm::mat4 scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.50f, 0.50f, 0.50f));
+    nodes.ghosts[0] = addGhostSculpture(scene, glm::vec3(0.7f, 0.5f, -2.0f), scaleMatrix);
+    nodes.ghosts[1] = addGhostSculpture(scene, glm::vec3(0.7f, 0.5f, 0.5f), scaleMatrix);
 
+    return nodes;
+}
 
+void classroom(Shader& lightingShader, const SceneGraph& scene, const ClassroomNodes& nodes, const GhostParts ghostParts[2])
+{
+    //fan
+    //drawSceneCubes(cubeVAO, lightingShader, scene, nodes.fanCubes);
 
-    
+    drawGhostSculpture(lightingShader, scene, nodes.ghosts[0], ghostParts[0]);
+    drawGhostSculpture(lightingShader, scene, nodes.ghosts[1], ghostParts[1]);
 }
-void drawAlmirah(Shader& shaderProgram, unsigned int VAO, glm::mat4 model) {
+void addAlmirah(SceneGraph& scene, SceneNode parent, vector<SceneCube>& cubes) {
     glm::mat4 identityMatrix = glm::mat4(1.0f);
 
     // Main Body of the Almira
     glm::mat4 almiraBodyTransform = glm::translate(identityMatrix, glm::vec3(0.0f, -1.0f, 0.0f)); // Positioning the almira
     almiraBodyTransform = glm::scale(almiraBodyTransform, glm::vec3(4.0f, 8.0f, 2.0f)); // Almira body size
-    almiraBodyTransform = almiraBodyTransform * model;
-    drawCube(VAO, shaderProgram, almiraBodyTransform, 0.5f, 0.3f, 0.1f); // Wood color for almira body
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, almiraBodyTransform, glm::vec3(0.5f, 0.3f, 0.1f), cubes); // Wood color for almira body
 
     // Left Door of the Almira
     glm::mat4 leftDoorTransform = glm::translate(identityMatrix, glm::vec3(-1.8f, -1.0f, 1.0f)); // Left door position
     leftDoorTransform = glm::scale(leftDoorTransform, glm::vec3(0.1f, 6.0f, 2.0f)); // Door dimensions
-    leftDoorTransform = leftDoorTransform * model;
-    drawCube(VAO, shaderProgram, leftDoorTransform, 0.4f, 0.2f, 0.1f); // Darker wood color for door
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, leftDoorTransform, glm::vec3(0.4f, 0.2f, 0.1f), cubes); // Darker wood color for door
 
     // Right Door of the Almira
     glm::mat4 rightDoorTransform = glm::translate(identityMatrix, glm::vec3(1.8f, -1.0f, 1.0f)); // Right door position
     rightDoorTransform = glm::scale(rightDoorTransform, glm::vec3(0.1f, 6.0f, 2.0f)); // Door dimensions
-    rightDoorTransform = rightDoorTransform * model;
-    drawCube(VAO, shaderProgram, rightDoorTransform, 0.4f, 0.2f, 0.1f); // Darker wood color for door
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Shelf 1 (middle shelf inside almira)
-    glm::mat4 shelf1Transform = glm::translate(identityMatrix, glm::vec3(0.0f, 0.5f, 0.0f)); // Shelf position (middle)
-    shelf1Transform = glm::scale(shelf1Transform, glm::vec3(4.0f, 0.1f, 2.0f)); // Shelf dimensions
-    shelf1Transform = shelf1Transform * model;
-    drawCube(VAO, shaderProgram, shelf1Transform, 0.3f, 0.2f, 0.1f); // Shelf color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Shelf 2 (bottom shelf inside almira)
-    glm::mat4 shelf2Transform = glm::translate(identityMatrix, glm::vec3(0.0f, -0.5f, 0.0f)); // Shelf position (bottom)
-    shelf2Transform = glm::scale(shelf2Transform, glm::vec3(4.0f, 0.1f, 2.0f)); // Shelf dimensions
-    shelf2Transform = shelf2Transform * model;
-    drawCube(VAO, shaderProgram, shelf2Transform, 0.3f, 0.2f, 0.1f); // Shelf color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-    // Shelf 3 (top shelf inside almira)
-    glm::mat4 shelf3Transform = glm::translate(identityMatrix, glm::vec3(0.0f, 1.5f, 0.0f)); // Shelf position (top)
-    shelf3Transform = glm::scale(shelf3Transform, glm::vec3(4.0f, 0.1f, 2.0f)); // Shelf dimensions
-    shelf3Transform = shelf3Transform * model;
-    drawCube(VAO, shaderProgram, shelf3Transform, 0.3f, 0.2f, 0.1f); // Shelf color
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, rightDoorTransform, glm::vec3(0.4f, 0.2f, 0.1f), cubes); // Darker wood color for door
+
+    // Shelves inside the almira: middle, bottom, top
+    const float shelfHeights[] = { 0.5f, -0.5f, 1.5f };
+    for (float shelfHeight : shelfHeights)
+    {
+        glm::mat4 shelfTransform = glm::translate(identityMatrix, glm::vec3(0.0f, shelfHeight, 0.0f)); // Shelf position
+        shelfTransform = glm::scale(shelfTransform, glm::vec3(4.0f, 0.1f, 2.0f)); // Shelf dimensions
+        addSceneCube(scene, parent, shelfTransform, glm::vec3(0.3f, 0.2f, 0.1f), cubes); // Shelf color
+    }
 
     // Back Panel of the Almira
     glm::mat4 backPanelTransform = glm::translate(identityMatrix, glm::vec3(0.0f, -1.0f, 2.0f)); // Back panel position
     backPanelTransform = glm::scale(backPanelTransform, glm::vec3(4.1f, 8.0f, 0.1f)); // Panel size
-    backPanelTransform = backPanelTransform * model;
-    drawCube(VAO, shaderProgram, backPanelTransform, 0.3f, 0.3f, 0.3f); // Dark gray color for back panel
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+    addSceneCube(scene, parent, backPanelTransform, glm::vec3(0.3f, 0.3f, 0.3f), cubes); // Dark gray color for back panel
 
     // Optional: Knobs for the doors (small spheres or cubes) could be added to the door if needed
 }
@@ -0,0 +1,139 @@
+//
+//  materialTable.h
+//  every distinct material of the scene once, in a uniform buffer the lighting
+//  shaders index; draws only carry the small index
+//
+
+#ifndef materialTable_h
+#define materialTable_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <iostream>
+#include "shader.h"
+#include "glState.h"
+#include "uniformBlocks.h"
+
+using namespace std;
+
+// attribute location of the material index: per instance in instanced draws,
+// per vertex in the baked static geometry
+const unsigned int MATERIAL_ID_LOCATION = 9;
+
+// the lighting shaders' Material struct
+struct MaterialState
+{
+    glm::vec3 ambient = glm::vec3(0.0f);
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    glm::vec3 specular = glm::vec3(0.0f);
+    glm::vec3 emissive = glm::vec3(0.0f);
+    float shininess = 32.0f;
+
+    bool operator==(const MaterialState& other) const
+    {
+        return ambient == other.ambient && diffuse == other.diffuse && specular == other.specular
+            && emissive == other.emissive && shininess == other.shininess;
+    }
+
+    // selects this material for the shader's next single draws
+    void apply(Shader& shader) const;
+};
+
+class MaterialTable
+{
+public:
+    MaterialTable()
+    {
+        glGenBuffers(1, &buffer);
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, MATERIAL_COUNT * sizeof(MaterialUniform), nullptr, GL_DYNAMIC_DRAW);
+        // stays bound, every lighting program reads the materials from the same binding point
+        GLState::bindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, buffer);
+    }
+
+    ~MaterialTable()
+    {
+        release();
+    }
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    // index of the material, equal materials share one; a new material is uploaded
+    // right away, past MATERIAL_COUNT the last one is reused
+    GLuint intern(const MaterialState& material)
+    {
+        for (size_t i = 0; i < materials.size(); ++i)
+        {
+            if (materials[i] == material)
+                return (GLuint)i;
+        }
+        if (materials.size() == MATERIAL_COUNT)
+        {
+            if (!overflowReported)
+                cout << "material table: more than " << MATERIAL_COUNT << " materials, the rest share the last" << endl;
+            overflowReported = true;
+            return MATERIAL_COUNT - 1;
+        }
+
+        GLuint index = (GLuint)materials.size();
+        materials.push_back(material);
+        MaterialUniform entry;
+        entry.ambient = glm::vec4(material.ambient, 1.0f);
+        entry.diffuse = glm::vec4(material.diffuse, 1.0f);
+        entry.specular = glm::vec4(material.specular, material.shininess);
+        entry.emissive = glm::vec4(material.emissive, 0.0f);
+        if (buffer != 0)
+        {
+            GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, index * sizeof(MaterialUniform), sizeof(MaterialUniform), &entry);
+        }
+        return index;
+    }
+
+    // free the uniform buffer; safe to call more than once
+    void release()
+    {
+        if (buffer != 0)
+        {
+            GLState::forgetBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+    }
+
+    size_t size() const { return materials.size(); }
+
+    // the table the draw paths intern into, null before one exists
+    static MaterialTable* current()
+    {
+        return currentTable();
+    }
+
+    static void setCurrent(MaterialTable* table)
+    {
+        currentTable() = table;
+    }
+
+private:
+    static MaterialTable*& currentTable()
+    {
+        static MaterialTable* table = nullptr;
+        return table;
+    }
+
+    vector<MaterialState> materials;
+    GLuint buffer = 0;
+    bool overflowReported = false;
+};
+
+// without a current table the shader keeps whatever material it had
+inline void MaterialState::apply(Shader& shader) const
+{
+    MaterialTable* table = MaterialTable::current();
+    if (table != nullptr)
+        shader.setInt("materialId", (int)table->intern(*this));
+}
+
+#endif /* materialTable_h */
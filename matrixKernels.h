@@ -0,0 +1,119 @@
+//
+//  matrixKernels.h
+//  batched mat4 products for the transform updates; AVX or SSE where the compiler
+//  targets them, glm otherwise. Every path sums the products in glm's order
+//
+
+#ifndef matrixKernels_h
+#define matrixKernels_h
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX__)
+#define MATRIX_KERNELS_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MATRIX_KERNELS_SSE
+#include <xmmintrin.h>
+#endif
+
+// the path compiled in, for the benchmark's report
+inline const char* matrixKernelName()
+{
+#if defined(MATRIX_KERNELS_AVX)
+    return "avx";
+#elif defined(MATRIX_KERNELS_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+}
+
+namespace matrixKernelsDetail
+{
+#if defined(MATRIX_KERNELS_AVX)
+    // two result columns per register: the columns of a repeated in both halves,
+    // times the matching entries of b's columns j and j + 1. Both inputs are read
+    // before out is written, so out may be either of them
+    inline __m256 multiplyColumns(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 columns)
+    {
+        __m256 sum = _mm256_mul_ps(a0, _mm256_permute_ps(columns, 0x00));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a1, _mm256_permute_ps(columns, 0x55)));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(a2, _mm256_permute_ps(columns, 0xAA)));
+        return _mm256_add_ps(sum, _mm256_mul_ps(a3, _mm256_permute_ps(columns, 0xFF)));
+    }
+
+    inline void multiply(const float* a, const float* b, float* out)
+    {
+        const __m256 a0 = _mm256_broadcast_ps((const __m128*)(a + 0));
+        const __m256 a1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+        const __m256 a2 = _mm256_broadcast_ps((const __m128*)(a + 8));
+        const __m256 a3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+        const __m256 b01 = _mm256_loadu_ps(b + 0);
+        const __m256 b23 = _mm256_loadu_ps(b + 8);
+        _mm256_storeu_ps(out + 0, multiplyColumns(a0, a1, a2, a3, b01));
+        _mm256_storeu_ps(out + 8, multiplyColumns(a0, a1, a2, a3, b23));
+    }
+#elif defined(MATRIX_KERNELS_SSE)
+    // both inputs are read before out is written, so out may be either of them
+    inline __m128 multiplyColumn(__m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 column)
+    {
+        __m128 sum = _mm_mul_ps(a0, _mm_shuffle_ps(column, column, 0x00));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_shuffle_ps(column, column, 0x55)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, 0xAA)));
+        return _mm_add_ps(sum, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, 0xFF)));
+    }
+
+    inline void multiply(const float* a, const float* b, float* out)
+    {
+        const __m128 a0 = _mm_loadu_ps(a + 0);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        const __m128 a2 = _mm_loadu_ps(a + 8);
+        const __m128 a3 = _mm_loadu_ps(a + 12);
+        const __m128 b0 = _mm_loadu_ps(b + 0);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        const __m128 b2 = _mm_loadu_ps(b + 8);
+        const __m128 b3 = _mm_loadu_ps(b + 12);
+        _mm_storeu_ps(out + 0, multiplyColumn(a0, a1, a2, a3, b0));
+        _mm_storeu_ps(out + 4, multiplyColumn(a0, a1, a2, a3, b1));
+        _mm_storeu_ps(out + 8, multiplyColumn(a0, a1, a2, a3, b2));
+        _mm_storeu_ps(out + 12, multiplyColumn(a0, a1, a2, a3, b3));
+    }
+#else
+    inline void multiply(const float* a, const float* b, float* out)
+    {
+        const glm::mat4 left = *(const glm::mat4*)a;
+        const glm::mat4 right = *(const glm::mat4*)b;
+        *(glm::mat4*)out = left * right;
+    }
+#endif
+}
+
+// out = a * b; out may be a or b
+inline void multiplyMatrix(const glm::mat4& a, const glm::mat4& b, glm::mat4& out)
+{
+    matrixKernelsDetail::multiply(&a[0][0], &b[0][0], &out[0][0]);
+}
+
+// out[i] = parents[i] * locals[i]. Results go every outStride bytes, so they can be
+// written straight into an interleaved instance or upload buffer
+inline void multiplyMatrices(const glm::mat4* parents, const glm::mat4* locals, size_t count,
+    void* out, size_t outStride = sizeof(glm::mat4))
+{
+    uint8_t* target = (uint8_t*)out;
+    for (size_t i = 0; i < count; ++i, target += outStride)
+        matrixKernelsDetail::multiply(&parents[i][0][0], &locals[i][0][0], (float*)target);
+}
+
+// out[i] = parent * locals[i], for the children of one node; parent must not be in out
+inline void multiplyMatrices(const glm::mat4& parent, const glm::mat4* locals, size_t count,
+    void* out, size_t outStride = sizeof(glm::mat4))
+{
+    uint8_t* target = (uint8_t*)out;
+    for (size_t i = 0; i < count; ++i, target += outStride)
+        matrixKernelsDetail::multiply(&parent[0][0], &locals[i][0][0], (float*)target);
+}
+
+#endif /* matrixKernels_h */
@@ -0,0 +1,344 @@
+//
+//  mesh.h
+//  GPU mesh shared by every primitive: one upload path and a global registry;
+//  the data lives in the GeometryPool of its vertex format
+//
+
+#ifndef mesh_h
+#define mesh_h
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <vector>
+#include "vertexFormat.h"
+#include "geometryPool.h"
+#include "glState.h"
+#include "frustum.h"
+
+using namespace std;
+
+class Mesh
+{
+public:
+    // interleaved position + normal vertices, stride in bytes
+    Mesh(const float* vertices, unsigned int vertexFloats, const unsigned int* indices, unsigned int indexCount, int stride = 24)
+    {
+        upload(vertices, vertexFloats, indices, indexCount, stride);
+        if (keepHostCopies())
+        {
+            hostVertices.assign(vertices, vertices + vertexFloats);
+            hostIndices.assign(indices, indices + indexCount);
+        }
+        meshes().push_back(this);
+    }
+
+    // takes over the host arrays; they are kept only if keepHostCopies() is set
+    Mesh(vector<float>&& vertices, vector<unsigned int>&& indices, int stride = 24)
+    {
+        upload(vertices.data(), (unsigned int)vertices.size(), indices.data(), (unsigned int)indices.size(), stride);
+        if (keepHostCopies())
+        {
+            hostVertices = std::move(vertices);
+            hostIndices = std::move(indices);
+        }
+        meshes().push_back(this);
+    }
+
+    // vertices and indices already in the GPU layout (an asset pack blob), handed to the
+    // pool as they are; the host arrays are left empty and read back on demand
+    Mesh(VertexFormat gpuFormat, const void* gpuVertices, unsigned int vertices, GLenum gpuIndexType, const void* gpuIndices,
+        unsigned int indices, int stride = 24)
+    {
+        verticesStride = stride;
+        vertexCount = vertices;
+        indexCount = indices;
+        format = gpuFormat;
+        indexType = gpuIndexType;
+        pool = &GeometryPool::forFormat(format);
+        gpuStride = pool->getStride();
+        allocation = pool->allocate(gpuVertices, vertexCount, gpuIndices, getGpuIndexSize());
+        bounds = gpuBounds((const unsigned char*)gpuVertices);
+        meshes().push_back(this);
+    }
+
+    ~Mesh()
+    {
+        release();
+        vector<Mesh*>& all = meshes();
+        all.erase(std::remove(all.begin(), all.end(), this), all.end());
+    }
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // the pool's VAO stays bound afterwards, consecutive draws from one pool bind it once
+    void draw() const
+    {
+        if (pool == nullptr)
+            return;
+        pool->bind();
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, (void*)allocation.indexOffset, allocation.baseVertex);
+    }
+
+    // give the ranges back to the pool; safe to call more than once
+    void release()
+    {
+        if (pool != nullptr)
+            pool->free(allocation);
+        pool = nullptr;
+    }
+
+    // the shared objects of the pool, 0 once released
+    unsigned int getVAO() const { return pool != nullptr ? pool->getVAO() : 0; }
+    unsigned int getVBO() const { return pool != nullptr ? pool->getVBO() : 0; }
+    unsigned int getEBO() const { return pool != nullptr ? pool->getEBO() : 0; }
+    GeometryPool* getPool() const { return pool; }
+    GLint getBaseVertex() const { return allocation.baseVertex; }
+    size_t getIndexOffset() const { return allocation.indexOffset; }       // in bytes, inside the pool's EBO
+    unsigned int getVertexCount() const { return vertexCount; }
+    unsigned int getIndexCount() const { return indexCount; }
+    int getVerticesStride() const { return verticesStride; }
+    unsigned int getVertexSize() const { return vertexCount * verticesStride; }          // # of bytes, as returned by getVertices()
+    unsigned int getIndexSize() const { return indexCount * sizeof(unsigned int); }      // # of bytes, as returned by getIndices()
+
+    // what actually lives in the buffers
+    VertexFormat getVertexFormat() const { return format; }
+    GLenum getIndexType() const { return indexType; }                                      // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    // object space box and sphere of the positions as the GPU has them
+    const Bounds& getBounds() const { return bounds; }
+    int getGpuStride() const { return gpuStride; }
+    unsigned int getGpuVertexSize() const { return vertexCount * gpuStride; }
+    unsigned int getGpuIndexSize() const { return indexCount * (indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int)); }
+
+    // host copies, read back from the GPU if they were released after upload
+    const float* getVertices() const
+    {
+        if (hostVertices.empty() && pool != nullptr)
+            readback();
+        return hostVertices.data();
+    }
+
+    const unsigned int* getIndices() const
+    {
+        if (hostIndices.empty() && pool != nullptr)
+            readback();
+        return hostIndices.data();
+    }
+
+    // raw buffer contents, in the GPU layout (what an asset pack stores)
+    void readGpuData(vector<unsigned char>& vertexData, vector<unsigned char>& indexData) const
+    {
+        vertexData.resize(getGpuVertexSize());
+        indexData.resize(getGpuIndexSize());
+        if (pool == nullptr)
+            return;
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, pool->getVBO());
+        glGetBufferSubData(GL_COPY_READ_BUFFER, (GLintptr)allocation.baseVertex * gpuStride, vertexData.size(), vertexData.data());
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, pool->getEBO());
+        glGetBufferSubData(GL_COPY_READ_BUFFER, allocation.indexOffset, indexData.size(), indexData.data());
+    }
+
+    // drop the host copies, getVertices()/getIndices() will read them back on demand
+    void releaseHostData() const
+    {
+        vector<float>().swap(hostVertices);
+        vector<unsigned int>().swap(hostIndices);
+    }
+
+    // memory accounting, in bytes
+    size_t getHostBytes() const
+    {
+        return hostVertices.capacity() * sizeof(float) + hostIndices.capacity() * sizeof(unsigned int);
+    }
+
+    size_t getGpuBytes() const
+    {
+        return pool != nullptr ? getGpuVertexSize() + getGpuIndexSize() : 0;
+    }
+
+    static size_t totalHostBytes()
+    {
+        size_t bytes = 0;
+        for (const Mesh* mesh : meshes())
+            bytes += mesh->getHostBytes();
+        return bytes;
+    }
+
+    static size_t totalGpuBytes()
+    {
+        size_t bytes = 0;
+        for (const Mesh* mesh : meshes())
+            bytes += mesh->getGpuBytes();
+        return bytes;
+    }
+
+    // whether meshes created from now on keep their host arrays after upload
+    static bool keepHostCopies()
+    {
+        return keepHost();
+    }
+
+    static void setKeepHostCopies(bool keep)
+    {
+        keepHost() = keep;
+    }
+
+    // GPU layout of meshes created from now on; VERTEX_COMPACT halves the vertex size,
+    // the shaders read both layouts unchanged
+    static VertexFormat vertexFormat()
+    {
+        return defaultFormat();
+    }
+
+    static void setVertexFormat(VertexFormat vertexFormat)
+    {
+        defaultFormat() = vertexFormat;
+    }
+
+    // every live mesh, in creation order
+    static const vector<Mesh*>& registry()
+    {
+        return meshes();
+    }
+
+    // release the pool ranges of every live mesh; the pools themselves go with
+    // GeometryPool::releaseAll()
+    static void releaseAll()
+    {
+        for (Mesh* mesh : meshes())
+            mesh->release();
+    }
+
+private:
+    void upload(const float* vertices, unsigned int vertexFloats, const unsigned int* indices, unsigned int count, int stride)
+    {
+        verticesStride = stride;
+        vertexCount = (unsigned int)(vertexFloats * sizeof(float) / stride);
+        indexCount = count;
+        format = vertexFormat();
+        // 16-bit indices whenever every vertex is addressable with them
+        indexType = vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+        pool = &GeometryPool::forFormat(format);
+        gpuStride = pool->getStride();
+
+        const int floatStride = stride / sizeof(float);
+        vector<unsigned char> packed(getGpuVertexSize());
+        for (unsigned int i = 0; i < vertexCount; ++i)
+        {
+            const float* in = vertices + i * floatStride;
+            unsigned char* out = packed.data() + i * gpuStride;
+            if (format == VERTEX_COMPACT)
+            {
+                uint16_t position[4] = { floatToHalf(in[0]), floatToHalf(in[1]), floatToHalf(in[2]), 0 };
+                uint32_t normal = packNormal(in[3], in[4], in[5]);
+                memcpy(out, position, sizeof(position));
+                memcpy(out + COMPACT_NORMAL_OFFSET, &normal, sizeof(normal));
+            }
+            else
+                memcpy(out, in, gpuStride);
+        }
+
+        bounds = gpuBounds(packed.data());
+
+        // indices stay relative to the mesh, the draw adds the base vertex
+        if (indexType == GL_UNSIGNED_SHORT)
+        {
+            vector<unsigned short> shortIndices(indices, indices + indexCount);
+            allocation = pool->allocate(packed.data(), vertexCount, shortIndices.data(), getGpuIndexSize());
+        }
+        else
+            allocation = pool->allocate(packed.data(), vertexCount, indices, getGpuIndexSize());
+    }
+
+    // positions in the GPU layout, so a compact mesh's box fits its rounded positions
+    Bounds gpuBounds(const unsigned char* gpuVertices) const
+    {
+        BoundsBuilder builder;
+        for (unsigned int i = 0; i < vertexCount; ++i)
+        {
+            const unsigned char* in = gpuVertices + i * gpuStride;
+            float position[3];
+            if (format == VERTEX_COMPACT)
+            {
+                uint16_t half[3];
+                memcpy(half, in, sizeof(half));
+                for (int k = 0; k < 3; ++k)
+                    position[k] = halfToFloat(half[k]);
+            }
+            else
+                memcpy(position, in, sizeof(position));
+            builder.add(position[0], position[1], position[2]);
+        }
+        return builder.build();
+    }
+
+    // copy the buffers back from the GPU into the host arrays, expanding compact data
+    void readback() const
+    {
+        hostVertices.assign(getVertexSize() / sizeof(float), 0.0f);
+        hostIndices.resize(indexCount);
+
+        vector<unsigned char> packed, packedIndices;
+        readGpuData(packed, packedIndices);
+        const int floatStride = verticesStride / sizeof(float);
+        for (unsigned int i = 0; i < vertexCount; ++i)
+        {
+            const unsigned char* in = packed.data() + i * gpuStride;
+            float* out = hostVertices.data() + i * floatStride;
+            if (format == VERTEX_COMPACT)
+            {
+                uint16_t position[3];
+                uint32_t normal;
+                memcpy(position, in, sizeof(position));
+                memcpy(&normal, in + COMPACT_NORMAL_OFFSET, sizeof(normal));
+                for (int k = 0; k < 3; ++k)
+                    out[k] = halfToFloat(position[k]);
+                unpackNormal(normal, out + 3);
+            }
+            else
+                memcpy(out, in, gpuStride);
+        }
+
+        if (indexType == GL_UNSIGNED_SHORT)
+        {
+            const unsigned short* shortIndices = (const unsigned short*)packedIndices.data();
+            hostIndices.assign(shortIndices, shortIndices + indexCount);
+        }
+        else
+            memcpy(hostIndices.data(), packedIndices.data(), packedIndices.size());
+    }
+
+    static bool& keepHost()
+    {
+        static bool keep = true;
+        return keep;
+    }
+
+    static VertexFormat& defaultFormat()
+    {
+        static VertexFormat format = VERTEX_FLOAT;
+        return format;
+    }
+
+    // never destroyed, meshes owned by other statics (the cache) may outlive it otherwise
+    static vector<Mesh*>& meshes()
+    {
+        static vector<Mesh*>* all = new vector<Mesh*>();
+        return *all;
+    }
+
+    GeometryPool* pool = nullptr;           // null once released
+    PoolAllocation allocation;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    int verticesStride = 24;                // # of bytes to hop to the next vertex
+    int gpuStride = 24;                     // same, inside the VBO
+    VertexFormat format = VERTEX_FLOAT;
+    GLenum indexType = GL_UNSIGNED_INT;
+    Bounds bounds;
+    mutable vector<float> hostVertices;     // empty once released, refilled by readback()
+    mutable vector<unsigned int> hostIndices;
+};
+
+#endif /* mesh_h */
@@ -0,0 +1,182 @@
+//
+//  meshCache.h
+//  process-wide cache of uploaded procedural meshes
+//
+
+#ifndef meshCache_h
+#define meshCache_h
+
+#include <glad/glad.h>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+#include "mesh.h"
+#include "meshKey.h"
+#include "meshOptimizer.h"
+#include "assetPack.h"
+#include "threadPool.h"
+
+using namespace std;
+
+// CPU side of a mesh, generated and optimized but not uploaded yet
+struct GeneratedMesh
+{
+    vector<float> vertices;                 // interleaved position + normal
+    vector<unsigned int> indices;
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// the optimizer's effect over every mesh generated so far, weighted by triangle count
+struct VertexCacheSummary
+{
+    unsigned int meshes = 0;
+    unsigned int triangles = 0;
+    float missesBefore = 0.0f;              // transformed vertices, ACMR times triangles
+    float missesAfter = 0.0f;
+
+    float acmrBefore() const { return triangles > 0 ? missesBefore / triangles : 0.0f; }
+    float acmrAfter() const { return triangles > 0 ? missesAfter / triangles : 0.0f; }
+
+    static VertexCacheSummary& current()
+    {
+        static VertexCacheSummary summary;
+        return summary;
+    }
+};
+
+// adds one generated mesh to the summary; on the thread that owns the context
+inline void recordVertexCache(unsigned int indexCount, const VertexCacheStats& before, const VertexCacheStats& after)
+{
+    VertexCacheSummary& summary = VertexCacheSummary::current();
+    const unsigned int triangles = indexCount / 3;
+    ++summary.meshes;
+    summary.triangles += triangles;
+    summary.missesBefore += before.acmr * triangles;
+    summary.missesAfter += after.acmr * triangles;
+}
+
+class MeshCache
+{
+public:
+    // returns the shared mesh for key; on a miss it comes from the current asset pack
+    // if that has it in the current vertex format, else build() generates and uploads it
+    template <typename BuildFunc>
+    static shared_ptr<Mesh> get(const MeshKey& key, BuildFunc build)
+    {
+        map<MeshKey, shared_ptr<Mesh>>& meshes = entries();
+        auto it = meshes.find(key);
+        if (it != meshes.end())
+            return it->second;
+
+        shared_ptr<Mesh> mesh = load(key);
+        if (!mesh)
+            mesh = takePrefetched(key);
+        if (!mesh)
+            mesh = build();
+        meshes[key] = mesh;
+        return mesh;
+    }
+
+    // starts generating key on the worker pool, so a later get() only uploads; keys that
+    // are cached, already queued or in the asset pack are skipped
+    static void prefetch(const MeshKey& key, function<GeneratedMesh()> generate)
+    {
+        if (entries().count(key) != 0 || pending().count(key) != 0)
+            return;
+        const AssetPack* pack = AssetPack::current();
+        if (pack != nullptr && pack->findMesh(key, Mesh::vertexFormat()) != nullptr)
+            return;
+        pending()[key] = ThreadPool::shared().submit(std::move(generate));
+    }
+
+    // the GL half of creating a mesh, on the thread that owns the context
+    static shared_ptr<Mesh> upload(GeneratedMesh&& generated)
+    {
+        recordVertexCache((unsigned int)generated.indices.size(), generated.before, generated.after);
+        return make_shared<Mesh>(std::move(generated.vertices), std::move(generated.indices));
+    }
+
+    // adds every cached mesh, as it sits in the GPU buffers, to a pack being written
+    static void exportTo(AssetPackWriter& writer)
+    {
+        for (auto& entry : entries())
+        {
+            const Mesh& mesh = *entry.second;
+            vector<unsigned char> vertexData, indexData;
+            mesh.readGpuData(vertexData, indexData);
+            writer.addMesh(entry.first, mesh.getVertexFormat(), mesh.getIndexType(), mesh.getVertexCount(),
+                mesh.getIndexCount(), std::move(vertexData), std::move(indexData));
+        }
+    }
+
+    // drop meshes nobody outside the cache references any more
+    static void purgeUnused()
+    {
+        map<MeshKey, shared_ptr<Mesh>>& meshes = entries();
+        for (auto it = meshes.begin(); it != meshes.end(); )
+        {
+            if (it->second.use_count() == 1)
+                it = meshes.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // release every GPU mesh, call while the GL context is still current
+    static void clear()
+    {
+        // wait for the generation still running, its results are not needed any more
+        for (auto& entry : pending())
+            entry.second.wait();
+        pending().clear();
+
+        map<MeshKey, shared_ptr<Mesh>>& meshes = entries();
+        for (auto& entry : meshes)
+            entry.second->release();
+        meshes.clear();
+    }
+
+    static size_t size()
+    {
+        return entries().size();
+    }
+
+private:
+    // blocks until the worker is done, if it is not yet
+    static shared_ptr<Mesh> takePrefetched(const MeshKey& key)
+    {
+        auto it = pending().find(key);
+        if (it == pending().end())
+            return shared_ptr<Mesh>();
+        GeneratedMesh generated = it->second.get();
+        pending().erase(it);
+        return upload(std::move(generated));
+    }
+
+    static shared_ptr<Mesh> load(const MeshKey& key)
+    {
+        const AssetPack* pack = AssetPack::current();
+        const AssetPackEntry* entry = pack != nullptr ? pack->findMesh(key, Mesh::vertexFormat()) : nullptr;
+        if (entry == nullptr)
+            return shared_ptr<Mesh>();
+        return make_shared<Mesh>((VertexFormat)entry->vertexFormat, pack->data(*entry), entry->vertexCount,
+            (GLenum)entry->indexType, pack->indexData(*entry), entry->indexCount);
+    }
+
+    static map<MeshKey, shared_ptr<Mesh>>& entries()
+    {
+        static map<MeshKey, shared_ptr<Mesh>> meshes;
+        return meshes;
+    }
+
+    static map<MeshKey, future<GeneratedMesh>>& pending()
+    {
+        static map<MeshKey, future<GeneratedMesh>> generating;
+        return generating;
+    }
+};
+
+#endif /* meshCache_h */
@@ -0,0 +1,45 @@
+//
+//  meshKey.h
+//  identity of a procedural mesh, shared by the cache and the asset pack
+//
+
+#ifndef meshKey_h
+#define meshKey_h
+
+enum MeshType
+{
+    MESH_SPHERE,
+    MESH_HEMISPHERE,
+    MESH_CONE,
+    MESH_CYLINDER,
+    MESH_CYLINDER_LYING
+};
+
+// everything that changes the generated geometry (material colors do not)
+struct MeshKey
+{
+    MeshType type;
+    float radius;
+    float topRadius;                        // cylinders only
+    float height;                           // cones and cylinders only
+    int sectorCount;
+    int stackCount;
+
+    bool operator<(const MeshKey& other) const
+    {
+        if (type != other.type) return type < other.type;
+        if (radius != other.radius) return radius < other.radius;
+        if (topRadius != other.topRadius) return topRadius < other.topRadius;
+        if (height != other.height) return height < other.height;
+        if (sectorCount != other.sectorCount) return sectorCount < other.sectorCount;
+        return stackCount < other.stackCount;
+    }
+
+    bool operator==(const MeshKey& other) const
+    {
+        return type == other.type && radius == other.radius && topRadius == other.topRadius
+            && height == other.height && sectorCount == other.sectorCount && stackCount == other.stackCount;
+    }
+};
+
+#endif /* meshKey_h */
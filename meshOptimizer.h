@@ -0,0 +1,218 @@
+//
+//  meshOptimizer.h
+//  post-transform vertex cache (Tipsify) and vertex fetch reordering of indexed
+//  triangle lists, plus ACMR/ATVR measurement; usable at compile time
+//
+
+#ifndef meshOptimizer_h
+#define meshOptimizer_h
+
+#include <vector>
+
+using namespace std;
+
+// FIFO entries assumed by both the optimizer and the statistics
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    float acmr;     // transformed vertices per triangle, 3 is worst, ~0.5 is the limit for large meshes
+    float atvr;     // transformed vertices per referenced vertex, 1 is ideal
+};
+
+// unsigned ints the passes below need as scratch
+constexpr unsigned int meshOptimizerScratchSize(unsigned int indexCount, unsigned int vertexCount)
+{
+    return 3 * vertexCount + 1 + 2 * indexCount + indexCount / 3;
+}
+
+// simulates a FIFO post-transform cache over the index order
+constexpr VertexCacheStats analyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int* scratch, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+{
+    unsigned int* loadedAt = scratch;       // miss count when the vertex entered the cache, 0 = never
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        loadedAt[v] = 0;
+
+    unsigned int misses = 0;
+    for (unsigned int i = 0; i < indexCount; ++i)
+    {
+        unsigned int v = indices[i];
+        if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize)
+            loadedAt[v] = ++misses;
+    }
+
+    unsigned int referenced = 0;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        if (loadedAt[v] != 0)
+            ++referenced;
+
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    if (indexCount >= 3)
+        stats.acmr = (float)misses / (indexCount / 3);
+    if (referenced > 0)
+        stats.atvr = (float)misses / referenced;
+    return stats;
+}
+
+// next vertex to fan around once the current one is exhausted: the most recently
+// emitted vertex that still has triangles, else the next one in input order
+constexpr int skipDeadEnd(const unsigned int* live, const unsigned int* deadEnd, unsigned int& deadEndSize,
+    unsigned int& cursor, unsigned int vertexCount)
+{
+    while (deadEndSize > 0)
+    {
+        unsigned int v = deadEnd[--deadEndSize];
+        if (live[v] > 0)
+            return (int)v;
+    }
+    for (; cursor < vertexCount; ++cursor)
+    {
+        if (live[cursor] > 0)
+            return (int)cursor++;
+    }
+    return -1;
+}
+
+// Tipsify (Sander, Nehab, Barczak 2007): emits the triangles around one vertex at a
+// time and moves on to a neighbour that is still in the cache
+constexpr void optimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+    unsigned int vertexCount, unsigned int* scratch, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+{
+    const unsigned int triangleCount = indexCount / 3;
+    unsigned int* offsets = scratch;                        // vertexCount + 1, start of each vertex's triangles
+    unsigned int* adjacency = offsets + vertexCount + 1;    // indexCount, triangles around each vertex
+    unsigned int* live = adjacency + indexCount;            // vertexCount, triangles not emitted yet
+    unsigned int* timestamp = live + vertexCount;           // vertexCount, when the vertex was last loaded
+    unsigned int* deadEnd = timestamp + vertexCount;        // indexCount, recently emitted vertices
+    unsigned int* emitted = deadEnd + indexCount;           // triangleCount
+
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        live[v] = 0;
+    for (unsigned int i = 0; i < triangleCount * 3; ++i)
+        ++live[indices[i]];
+
+    offsets[0] = 0;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        offsets[v + 1] = offsets[v] + live[v];
+        timestamp[v] = offsets[v];                          // write cursor while filling adjacency
+    }
+    for (unsigned int t = 0; t < triangleCount; ++t)
+    {
+        emitted[t] = 0;
+        for (int k = 0; k < 3; ++k)
+            adjacency[timestamp[indices[t * 3 + k]]++] = t;
+    }
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        timestamp[v] = 0;
+
+    unsigned int out = 0;
+    unsigned int time = cacheSize + 1;
+    unsigned int deadEndSize = 0;
+    unsigned int cursor = 0;
+    int fanning = skipDeadEnd(live, deadEnd, deadEndSize, cursor, vertexCount);
+
+    while (fanning >= 0)
+    {
+        unsigned int fanStart = out;
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; ++a)
+        {
+            unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            for (int k = 0; k < 3; ++k)
+            {
+                unsigned int v = indices[t * 3 + k];
+                destination[out++] = v;
+                deadEnd[deadEndSize++] = v;
+                --live[v];
+                if (time - timestamp[v] > cacheSize)
+                    timestamp[v] = time++;
+            }
+            emitted[t] = 1;
+        }
+
+        // the fan's vertex that stays in the cache longest while its own fan is emitted
+        int best = -1;
+        int bestPriority = -1;
+        for (unsigned int i = fanStart; i < out; ++i)
+        {
+            unsigned int v = destination[i];
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - timestamp[v] + 2 * live[v] <= cacheSize)
+                priority = (int)(time - timestamp[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = (int)v;
+            }
+        }
+        fanning = best >= 0 ? best : skipDeadEnd(live, deadEnd, deadEndSize, cursor, vertexCount);
+    }
+}
+
+// renumbers vertices in first use order so the vertex fetch walks memory linearly;
+// unreferenced vertices keep their order at the end, the vertex count never changes
+constexpr void optimizeVertexFetch(float* destination, unsigned int* indices, unsigned int indexCount,
+    const float* vertices, unsigned int vertexCount, unsigned int floatsPerVertex, unsigned int* remap)
+{
+    const unsigned int unused = ~0u;
+    for (unsigned int v = 0; v < vertexCount; ++v)
+        remap[v] = unused;
+
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < indexCount; ++i)
+    {
+        unsigned int& target = remap[indices[i]];
+        if (target == unused)
+            target = next++;
+        indices[i] = target;
+    }
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] == unused)
+            remap[v] = next++;
+    }
+
+    for (unsigned int v = 0; v < vertexCount; ++v)
+    {
+        for (unsigned int k = 0; k < floatsPerVertex; ++k)
+            destination[remap[v] * floatsPerVertex + k] = vertices[v * floatsPerVertex + k];
+    }
+}
+
+// both passes over caller owned buffers; the optimized mesh ends up back in
+// vertices/indices, the statistics are taken before and after
+constexpr void optimizeMeshBuffers(float* vertices, unsigned int* indices, unsigned int vertexCount, unsigned int indexCount,
+    unsigned int floatsPerVertex, unsigned int* scratch, float* scratchVertices, unsigned int* scratchIndices,
+    VertexCacheStats& before, VertexCacheStats& after)
+{
+    before = analyzeVertexCache(indices, indexCount, vertexCount, scratch);
+    optimizeVertexCache(scratchIndices, indices, indexCount, vertexCount, scratch);
+    optimizeVertexFetch(scratchVertices, scratchIndices, indexCount, vertices, vertexCount, floatsPerVertex, scratch);
+    after = analyzeVertexCache(scratchIndices, indexCount, vertexCount, scratch);
+
+    for (unsigned int i = 0; i < indexCount; ++i)
+        indices[i] = scratchIndices[i];
+    for (unsigned int i = 0; i < vertexCount * floatsPerVertex; ++i)
+        vertices[i] = scratchVertices[i];
+}
+
+// runtime version for generated host arrays
+inline void optimizeMesh(vector<float>& vertices, vector<unsigned int>& indices, unsigned int floatsPerVertex,
+    VertexCacheStats& before, VertexCacheStats& after)
+{
+    unsigned int vertexCount = (unsigned int)(vertices.size() / floatsPerVertex);
+    unsigned int indexCount = (unsigned int)indices.size();
+    vector<unsigned int> scratch(meshOptimizerScratchSize(indexCount, vertexCount));
+    vector<float> scratchVertices(vertices.size());
+    vector<unsigned int> scratchIndices(indexCount);
+
+    optimizeMeshBuffers(vertices.data(), indices.data(), vertexCount, indexCount, floatsPerVertex,
+        scratch.data(), scratchVertices.data(), scratchIndices.data(), before, after);
+}
+
+#endif /* meshOptimizer_h */
@@ -0,0 +1,285 @@
+//
+//  parametricSurface.h
+//  table driven, vectorized generator for surfaces of revolution
+//
+
+#ifndef parametricSurface_h
+#define parametricSurface_h
+
+#include <cmath>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARAMETRIC_SURFACE_AVX 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARAMETRIC_SURFACE_SSE 1
+#endif
+
+using namespace std;
+
+// which vertex component receives r*sin, r*cos and the axial coordinate
+// sphere and hemisphere: x = r*sin, z = r*cos, axis along y
+struct SphereLayout
+{
+    static const int sinComponent = 0;
+    static const int cosComponent = 2;
+    static const int axisComponent = 1;
+};
+
+// upright cylinder and cone: x = r*cos, z = r*sin, axis along y
+struct UprightLayout
+{
+    static const int sinComponent = 2;
+    static const int cosComponent = 0;
+    static const int axisComponent = 1;
+};
+
+// lying cylinder: x = r*cos, y = r*sin, axis along z
+struct LyingLayout
+{
+    static const int sinComponent = 1;
+    static const int cosComponent = 0;
+    static const int axisComponent = 2;
+};
+
+// sin/cos of every sector angle (sectorCount + 1 entries, the seam is duplicated)
+class SectorTable
+{
+public:
+    const float* sines;
+    const float* cosines;
+
+    // one table per thread, rebuilt only when the sector count changes; the reference
+    // stays valid until the next get() with other parameters on the same thread
+    static const SectorTable& get(int sectorCount, float fullAngle)
+    {
+        thread_local SectorTable table;
+        if (table.sectorCount != sectorCount || table.fullAngle != fullAngle)
+            table.build(sectorCount, fullAngle);
+        return table;
+    }
+
+private:
+    void build(int sectors, float angle)
+    {
+        sectorCount = sectors;
+        fullAngle = angle;
+        if (sinStorage.size() < (size_t)sectors + 1)
+        {
+            sinStorage.resize(sectors + 1);
+            cosStorage.resize(sectors + 1);
+        }
+        float sectorStep = angle / sectors;
+        for (int j = 0; j <= sectors; ++j)
+        {
+            sinStorage[j] = sinf(j * sectorStep);
+            cosStorage[j] = cosf(j * sectorStep);
+        }
+        sines = sinStorage.data();
+        cosines = cosStorage.data();
+    }
+
+    int sectorCount = -1;
+    float fullAngle = 0.0f;
+    vector<float> sinStorage;
+    vector<float> cosStorage;
+};
+
+// vertex and index counts of the pieces a surface is made of, so callers can size
+// their buffers before generating
+struct SurfaceTopology
+{
+    static constexpr unsigned int ringVertexCount(int sectorCount) { return sectorCount + 1; }
+
+    static constexpr unsigned int stripIndexCount(int sectorCount, int bandCount, bool poleAtFirst, bool poleAtLast)
+    {
+        int collapsed = (poleAtFirst ? 1 : 0) + (poleAtLast ? 1 : 0);
+        if (bandCount == 1 && collapsed == 2)
+            collapsed = 1;
+        return 3 * sectorCount * (2 * bandCount - collapsed);
+    }
+
+    static constexpr unsigned int fanIndexCount(int sectorCount) { return 3 * sectorCount; }
+};
+
+// writes interleaved position + normal vertices and triangle indices straight into
+// caller sized buffers
+template <typename Layout>
+class SurfaceOfRevolution : public SurfaceTopology
+{
+public:
+    SurfaceOfRevolution(int sectorCount, float fullAngle, float* vertices, unsigned int* indices)
+        : table(SectorTable::get(sectorCount, fullAngle)), sectorCount(sectorCount), vertices(vertices), indices(indices)
+    {
+    }
+
+    // trig for the per-ring angles of the shape recipes
+    static float sine(float angle) { return sinf(angle); }
+    static float cosine(float angle) { return cosf(angle); }
+
+    // a full ring of sectorCount + 1 vertices at the given radius and axial position;
+    // the normal is normalRadial outward plus normalAxial along the axis
+    unsigned int ring(float radius, float axial, float normalRadial, float normalAxial)
+    {
+        unsigned int first = vertexCount;
+        float* out = vertices + (size_t)vertexCount * 6;
+        const int n = sectorCount + 1;
+        int j = 0;
+
+#if defined(PARAMETRIC_SURFACE_AVX)
+        {
+            const __m256 r = _mm256_set1_ps(radius);
+            const __m256 nr = _mm256_set1_ps(normalRadial);
+            const __m256 a = _mm256_set1_ps(axial);
+            const __m256 na = _mm256_set1_ps(normalAxial);
+            for (; j + 8 <= n; j += 8)
+            {
+                __m256 s = _mm256_loadu_ps(table.sines + j);
+                __m256 c = _mm256_loadu_ps(table.cosines + j);
+                __m256 comp[6];
+                comp[Layout::sinComponent] = _mm256_mul_ps(r, s);
+                comp[Layout::cosComponent] = _mm256_mul_ps(r, c);
+                comp[Layout::axisComponent] = a;
+                comp[3 + Layout::sinComponent] = _mm256_mul_ps(nr, s);
+                comp[3 + Layout::cosComponent] = _mm256_mul_ps(nr, c);
+                comp[3 + Layout::axisComponent] = na;
+
+                __m128 lo[6], hi[6];
+                for (int k = 0; k < 6; ++k)
+                {
+                    lo[k] = _mm256_castps256_ps128(comp[k]);
+                    hi[k] = _mm256_extractf128_ps(comp[k], 1);
+                }
+                storeInterleaved4(out + j * 6, lo);
+                storeInterleaved4(out + (j + 4) * 6, hi);
+            }
+        }
+#endif
+#if defined(PARAMETRIC_SURFACE_SSE)
+        {
+            const __m128 r = _mm_set1_ps(radius);
+            const __m128 nr = _mm_set1_ps(normalRadial);
+            const __m128 a = _mm_set1_ps(axial);
+            const __m128 na = _mm_set1_ps(normalAxial);
+            for (; j + 4 <= n; j += 4)
+            {
+                __m128 s = _mm_loadu_ps(table.sines + j);
+                __m128 c = _mm_loadu_ps(table.cosines + j);
+                __m128 comp[6];
+                comp[Layout::sinComponent] = _mm_mul_ps(r, s);
+                comp[Layout::cosComponent] = _mm_mul_ps(r, c);
+                comp[Layout::axisComponent] = a;
+                comp[3 + Layout::sinComponent] = _mm_mul_ps(nr, s);
+                comp[3 + Layout::cosComponent] = _mm_mul_ps(nr, c);
+                comp[3 + Layout::axisComponent] = na;
+                storeInterleaved4(out + j * 6, comp);
+            }
+        }
+#endif
+        for (; j < n; ++j)
+        {
+            float* v = out + j * 6;
+            v[Layout::sinComponent] = radius * table.sines[j];
+            v[Layout::cosComponent] = radius * table.cosines[j];
+            v[Layout::axisComponent] = axial;
+            v[3 + Layout::sinComponent] = normalRadial * table.sines[j];
+            v[3 + Layout::cosComponent] = normalRadial * table.cosines[j];
+            v[3 + Layout::axisComponent] = normalAxial;
+        }
+
+        vertexCount += n;
+        return first;
+    }
+
+    // a single vertex on the axis (cap centers, apex)
+    unsigned int point(float axial, float normalAxial)
+    {
+        float* v = vertices + (size_t)vertexCount * 6;
+        v[0] = v[1] = v[2] = v[3] = v[4] = v[5] = 0.0f;
+        v[Layout::axisComponent] = axial;
+        v[3 + Layout::axisComponent] = normalAxial;
+        return vertexCount++;
+    }
+
+    // two triangles per sector between consecutive rings; the first and last band
+    // collapse to one triangle per sector where they meet a pole
+    // k1--k1+1
+    // |  / |
+    // | /  |
+    // k2--k2+1
+    void strip(unsigned int firstRing, int bandCount, bool poleAtFirst, bool poleAtLast)
+    {
+        const unsigned int ringSize = sectorCount + 1;
+        for (int i = 0; i < bandCount; ++i)
+        {
+            unsigned int k1 = firstRing + i * ringSize;
+            unsigned int k2 = k1 + ringSize;
+            bool topPole = poleAtFirst && i == 0;
+            bool bottomPole = poleAtLast && i == bandCount - 1 && !topPole;
+            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+            {
+                // k1 => k2 => k1+1
+                if (!topPole)
+                    emit(k1, k2, k1 + 1);
+
+                // k1+1 => k2 => k2+1
+                if (!bottomPole)
+                    emit(k1 + 1, k2, k2 + 1);
+            }
+        }
+    }
+
+    // triangle fan from center to every sector of the ring starting at ringStart
+    void fan(unsigned int center, unsigned int ringStart, bool reversed)
+    {
+        for (int j = 0; j < sectorCount; ++j)
+        {
+            if (reversed)
+                emit(center, ringStart + j + 1, ringStart + j);
+            else
+                emit(center, ringStart + j, ringStart + j + 1);
+        }
+    }
+
+    unsigned int getVertexCount() const { return vertexCount; }
+    unsigned int getIndexCount() const { return indexCount; }
+
+private:
+#if defined(PARAMETRIC_SURFACE_SSE)
+    // 4 vertices from 6 component registers into 24 interleaved floats
+    static void storeInterleaved4(float* out, const __m128* comp)
+    {
+        __m128 r0 = comp[0], r1 = comp[1], r2 = comp[2], r3 = comp[3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);              // rk = x y z nx of vertex k
+        __m128 lo = _mm_unpacklo_ps(comp[4], comp[5]);  // ny0 nz0 ny1 nz1
+        __m128 hi = _mm_unpackhi_ps(comp[4], comp[5]);  // ny2 nz2 ny3 nz3
+        _mm_storeu_ps(out, r0);
+        _mm_storel_pi((__m64*)(out + 4), lo);
+        _mm_storeu_ps(out + 6, r1);
+        _mm_storeh_pi((__m64*)(out + 10), lo);
+        _mm_storeu_ps(out + 12, r2);
+        _mm_storel_pi((__m64*)(out + 16), hi);
+        _mm_storeu_ps(out + 18, r3);
+        _mm_storeh_pi((__m64*)(out + 22), hi);
+    }
+#endif
+
+    void emit(unsigned int a, unsigned int b, unsigned int c)
+    {
+        indices[indexCount++] = a;
+        indices[indexCount++] = b;
+        indices[indexCount++] = c;
+    }
+
+    const SectorTable& table;
+    int sectorCount;
+    float* vertices;
+    unsigned int* indices;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+};
+
+#endif /* parametricSurface_h */
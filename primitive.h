@@ -0,0 +1,271 @@
+//
+//  primitive.h
+//  common base of the procedural shapes (sphere, hemisphere, cone, cylinders)
+//
+
+#ifndef primitive_h
+#define primitive_h
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "shader.h"
+#include "mesh.h"
+#include "meshCache.h"
+#include "parametricSurface.h"
+#include "geometryTables.h"
+#include "meshOptimizer.h"
+#include "lod.h"
+#include "renderQueue.h"
+#include "transform.h"
+#include "frustum.h"
+
+# define PI 3.1416
+
+using namespace std;
+
+const int MIN_SECTOR_COUNT = 3;
+const int MIN_STACK_COUNT = 2;
+
+// fills interleaved vertices and indices for the shape and tessellation in key; takes
+// no instance, so it can run on a worker thread
+typedef void (*MeshGenerator)(const MeshKey& key, vector<float>& vertices, vector<unsigned int>& indices);
+
+class Primitive
+{
+public:
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float shininess;
+
+    virtual ~Primitive() {}
+
+    // for interleaved vertices
+    unsigned int getVertexCount() const { return mesh->getVertexCount(); }     // # of vertices
+    unsigned int getVertexSize() const { return mesh->getVertexSize(); }       // # of bytes
+    int getVerticesStride() const { return verticesStride; }                  // should be 24 bytes
+    const float* getVertices() const { return mesh->getVertices(); }
+    unsigned int getIndexSize() const { return mesh->getIndexSize(); }         // # of bytes
+    const unsigned int* getIndices() const { return mesh->getIndices(); }
+    unsigned int getIndexCount() const { return mesh->getIndexCount(); }
+
+    // memory accounting of the (possibly shared) mesh, in bytes
+    size_t getHostBytes() const { return mesh->getHostBytes(); }
+    size_t getGpuBytes() const { return mesh->getGpuBytes(); }
+
+    // the GPU buffers (full detail level), shareable with any other primitive
+    shared_ptr<Mesh> getMesh() const { return mesh; }
+    void setMesh(shared_ptr<Mesh> other)
+    {
+        mesh = other;
+        lods.assign(1, LodLevel{ other, lods.empty() ? 0 : lods[0].sectorCount });
+        lodLevel = 0;
+    }
+
+    // level of detail chain, level 0 is the authored tessellation
+    int getLodCount() const { return (int)lods.size(); }
+    int getLodLevel() const { return lodLevel; }
+    shared_ptr<Mesh> getLodMesh(int level) const { return lods[level].mesh; }
+
+    // object space box and sphere of the full detail mesh, the coarser levels fit inside
+    const Bounds& getBounds() const { return mesh->getBounds(); }
+
+    // draw in VertexArray mode; goes through the current render queue when there is one.
+    // Nothing is submitted or set for a primitive outside the frame's view frustum
+    void drawPrimitive(Shader& lightingShader, glm::mat4 model) const
+    {
+        if (!FrustumCulling::isVisible(getBounds(), model))
+            return;
+        const shared_ptr<Mesh>& lodMesh = lods[selectLod(model)].mesh;
+        RenderQueue* queue = RenderQueue::current();
+        if (queue != nullptr)
+        {
+            DrawPacket packet;
+            packet.shader = &lightingShader;
+            packet.mesh = lodMesh;
+            packet.material = getMaterial();
+            packet.model = model;
+            packet.center = boundsCenter;
+            queue->submit(std::move(packet));
+            return;
+        }
+
+        lightingShader.use();
+        getMaterial().apply(lightingShader);
+        lightingShader.setMat4("model", model);
+        lightingShader.setMat3("normalMatrix", normalMatrix(model));
+        lodMesh->draw();
+    }
+
+    virtual MaterialState getMaterial() const
+    {
+        MaterialState material;
+        material.ambient = ambient;
+        material.diffuse = diffuse;
+        material.specular = specular;
+        material.shininess = shininess;
+        return material;
+    }
+
+protected:
+    Primitive() : verticesStride(24) {}
+
+    // object space bounding sphere, drives the level of detail selection
+    void setBoundingSphere(glm::vec3 center, float radius)
+    {
+        boundsCenter = center;
+        boundsRadius = radius;
+    }
+
+    // identical geometry is generated and uploaded only once per process
+    void createMesh(const MeshKey& key, MeshGenerator generate)
+    {
+        generator = generate;
+        mesh = generateMesh(key);
+        createLodChain(key);
+    }
+
+    // a key matching the one a table was baked for uploads the table as is, any
+    // other key falls back to generating the geometry at runtime
+    template <typename Table>
+    void createMesh(const MeshKey& key, MeshGenerator generate, const MeshKey& tableKey, const Table& table)
+    {
+        if (!(key == tableKey))
+        {
+            createMesh(key, generate);
+            return;
+        }
+        generator = generate;
+        mesh = MeshCache::get(key, [this, &table]() {
+            recordVertexCache(Table::indexCount, table.unoptimized, table.optimized);
+            return make_shared<Mesh>(table.vertices, Table::vertexCount * 6, table.indices, Table::indexCount, verticesStride);
+        });
+        createLodChain(key);
+    }
+
+    // uploads what a prefetch already generated, or generates it right here
+    shared_ptr<Mesh> generateMesh(const MeshKey& key)
+    {
+        MeshGenerator generate = generator;
+        return MeshCache::get(key, [&key, generate]() {
+            return MeshCache::upload(generateOptimized(key, generate));
+        });
+    }
+
+    // the CPU half of generateMesh(), safe on any thread
+    static GeneratedMesh generateOptimized(const MeshKey& key, MeshGenerator generate)
+    {
+        GeneratedMesh generated;
+        generate(key, generated.vertices, generated.indices);
+        optimizeMesh(generated.vertices, generated.indices, 6, generated.before, generated.after);
+        return generated;
+    }
+
+    // queues key and its coarser levels on the worker pool; the first level is skipped when
+    // it comes from a compile time table
+    static void prefetchMesh(const MeshKey& key, MeshGenerator generate, bool firstLevelBaked)
+    {
+        vector<MeshKey> levels = lodChain(key);
+        for (size_t i = firstLevelBaked ? 1 : 0; i < levels.size(); ++i)
+        {
+            MeshKey level = levels[i];
+            MeshCache::prefetch(level, [level, generate]() { return generateOptimized(level, generate); });
+        }
+    }
+
+    // key followed by its coarser versions, each halving the sectors and stacks of the previous one
+    static vector<MeshKey> lodChain(const MeshKey& key)
+    {
+        vector<MeshKey> levels(1, key);
+        MeshKey level = key;
+        while ((int)levels.size() < LOD_MAX_LEVELS && level.sectorCount / 2 >= LOD_MIN_SECTOR_COUNT)
+        {
+            level.sectorCount /= 2;
+            level.stackCount = max(level.stackCount / 2, min(level.stackCount, MIN_STACK_COUNT));
+            levels.push_back(level);
+        }
+        return levels;
+    }
+
+    // the coarser levels go through the cache too, so instances with the same shape share them
+    void createLodChain(const MeshKey& key)
+    {
+        vector<MeshKey> levels = lodChain(key);
+        lods.assign(1, LodLevel{ mesh, key.sectorCount });
+        lodLevel = 0;
+        for (size_t i = 1; i < levels.size(); ++i)
+            lods.push_back(LodLevel{ generateMesh(levels[i]), levels[i].sectorCount });
+    }
+
+    // the level for this draw, from the projected size of the bounding sphere
+    int selectLod(const glm::mat4& model) const
+    {
+        if (lods.size() < 2 || !LodContext::hasFrame())
+            return 0;
+
+        int sectorCounts[LOD_MAX_LEVELS];
+        for (size_t i = 0; i < lods.size(); ++i)
+            sectorCounts[i] = lods[i].sectorCount;
+
+        float radiusPixels = LodContext::projectedRadius(model, boundsCenter, boundsRadius);
+        lodLevel = LodContext::selectLevel(sectorCounts, (int)lods.size(), lodLevel, radiusPixels);
+        return lodLevel;
+    }
+
+    vector<float> computeFaceNormal(float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3)
+    {
+        const float EPSILON = 0.000001f;
+
+        vector<float> normal(3, 0.0f);     // default return value (0,0,0)
+        float nx, ny, nz;
+
+        // find 2 edge vectors: v1-v2, v1-v3
+        float ex1 = x2 - x1;
+        float ey1 = y2 - y1;
+        float ez1 = z2 - z1;
+        float ex2 = x3 - x1;
+        float ey2 = y3 - y1;
+        float ez2 = z3 - z1;
+
+        // cross product: e1 x e2
+        nx = ey1 * ez2 - ez1 * ey2;
+        ny = ez1 * ex2 - ex1 * ez2;
+        nz = ex1 * ey2 - ey1 * ex2;
+
+        // normalize only if the length is > 0
+        float length = sqrtf(nx * nx + ny * ny + nz * nz);
+        if (length > EPSILON)
+        {
+            // normalize
+            float lengthInv = 1.0f / length;
+            normal[0] = nx * lengthInv;
+            normal[1] = ny * lengthInv;
+            normal[2] = nz * lengthInv;
+        }
+
+        return normal;
+    }
+
+    struct LodLevel
+    {
+        shared_ptr<Mesh> mesh;
+        int sectorCount;
+    };
+
+    // memeber vars
+    shared_ptr<Mesh> mesh;                  // shared through MeshCache
+    vector<LodLevel> lods;                  // mesh first, then coarser levels
+    mutable int lodLevel = 0;               // last level drawn, for the hysteresis
+    glm::vec3 boundsCenter = glm::vec3(0.0f);
+    float boundsRadius = 1.0f;
+    MeshGenerator generator = nullptr;      // of the shape, for the coarser levels
+    int verticesStride;                     // # of bytes to hop to the next vertex (should be 24 bytes)
+};
+
+#endif /* primitive_h */
@@ -0,0 +1,389 @@
+//
+//  renderQueue.h
+//  draws collected over a frame, radix sorted by a 64-bit key so the
+//  program, VAO and material are only switched when they actually change;
+//  on GL 4.3 class hardware each run of one program and VAO is a single
+//  glMultiDrawElementsIndirect
+//
+
+#ifndef renderQueue_h
+#define renderQueue_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "shader.h"
+#include "mesh.h"
+#include "glExtensions.h"
+#include "glState.h"
+#include "streamBuffer.h"
+#include "uniformBlocks.h"
+#include "materialTable.h"
+#include "transform.h"
+
+using namespace std;
+
+// one draw as the draw sites submit it
+struct DrawPacket
+{
+    Shader* shader = nullptr;
+    shared_ptr<Mesh> mesh;                  // held until the flush, the submitting object may be gone by then
+    MaterialState material;
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::vec3 center = glm::vec3(0.0f);     // object space point the depth is measured at
+    bool transparent = false;
+};
+
+// state changes of the last flush, and what the same draws cost in submission order
+struct RenderQueueStats
+{
+    unsigned int draws = 0;
+    unsigned int drawCalls = 0;             // GL calls, a multi-draw counts once
+    unsigned int programChanges = 0;
+    unsigned int vaoChanges = 0;
+    unsigned int materialChanges = 0;
+    unsigned int unsortedChanges = 0;       // program + VAO + material changes without sorting
+
+    unsigned int stateChanges() const { return programChanges + vaoChanges + materialChanges; }
+};
+
+// key layout, most significant first:
+//   opaque       0 | program 8 | VAO 8 | material 12 | depth 24 (front to back) | 11 unused
+//   transparent  1 | inverted depth 24 (back to front) | program 8 | VAO 8 | material 12 | 11 unused
+const int RENDER_KEY_DEPTH_BITS = 24;
+const int RENDER_KEY_MATERIAL_BITS = 12;
+// most draws one frame may send through the indirect path, the rest fall back to single draws
+const unsigned int RENDER_QUEUE_MAX_INDIRECT_DRAWS = 1024;
+
+class RenderQueue
+{
+public:
+    RenderQueue() {}
+
+    ~RenderQueue()
+    {
+        release();
+    }
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // packets submitted with shader are drawn with indirect instead, one multi-draw per run;
+    // ignored without multi-draw indirect support
+    void setIndirectShader(const Shader& shader, Shader* indirect)
+    {
+        if (!GLExtensions::hasMultiDrawIndirect() || indirect == nullptr)
+            return;
+        if (commandStream == nullptr)
+        {
+            commandStream.reset(new StreamBuffer(GL_DRAW_INDIRECT_BUFFER, RENDER_QUEUE_MAX_INDIRECT_DRAWS * sizeof(DrawElementsIndirectCommand)));
+            drawDataStream.reset(new StreamBuffer(GL_SHADER_STORAGE_BUFFER, RENDER_QUEUE_MAX_INDIRECT_DRAWS * sizeof(DrawData)));
+        }
+        indirectShaders.push_back(make_pair(shader.ID, indirect));
+    }
+
+    // fences the indirect path's buffers like every other stream buffer
+    void beginFrame()
+    {
+        if (commandStream != nullptr)
+        {
+            commandStream->beginFrame();
+            drawDataStream->beginFrame();
+        }
+    }
+
+    void endFrame()
+    {
+        if (commandStream != nullptr)
+        {
+            commandStream->endFrame();
+            drawDataStream->endFrame();
+        }
+    }
+
+    // free the indirect path's buffers; safe to call more than once
+    void release()
+    {
+        commandStream.reset();
+        drawDataStream.reset();
+        indirectShaders.clear();
+    }
+
+    bool isIndirect() const { return !indirectShaders.empty(); }
+
+    // camera of the frame, for the depth part of the keys; farPlane maps to the largest depth
+    void setView(const glm::mat4& view, float farPlane)
+    {
+        this->view = view;
+        this->farPlane = farPlane > 0.0f ? farPlane : 1.0f;
+    }
+
+    void submit(DrawPacket&& packet)
+    {
+        if (packet.shader == nullptr || packet.mesh == nullptr || packet.mesh->getPool() == nullptr)
+            return;
+        // ids from the material table are stable across frames, equal materials share one
+        MaterialTable* table = MaterialTable::current();
+        uint32_t materialId = table != nullptr ? table->intern(packet.material) : 0;
+        SortEntry entry;
+        entry.key = makeKey(packet, materialId);
+        entry.packet = (uint32_t)packets.size();
+        entries.push_back(entry);
+        materialIds.push_back(materialId);
+        packets.push_back(std::move(packet));
+    }
+
+    // sorts and draws everything submitted since the last flush
+    void flush()
+    {
+        stats = RenderQueueStats();
+        stats.draws = (unsigned int)packets.size();
+        if (packets.empty())
+            return;
+
+        // what the draws would have switched in the order they came in
+        for (size_t i = 0; i < packets.size(); ++i)
+            stats.unsortedChanges += changesFrom(i == 0 ? nullptr : &packets[i - 1], i == 0 ? 0 : materialIds[i - 1], packets[i], materialIds[i]);
+
+        radixSort(entries, scratch);
+
+        // runs of one program, VAO and index type go out together
+        Bound bound;
+        bool blending = false;
+        size_t begin = 0;
+        while (begin < entries.size())
+        {
+            const DrawPacket& head = packets[entries[begin].packet];
+            size_t end = begin + 1;
+            while (end < entries.size() && sameRun(head, packets[entries[end].packet]))
+                ++end;
+
+            if (head.transparent && !blending)
+            {
+                GLState::setBlend(true);
+                GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                GLState::setDepthMask(false);
+                blending = true;
+            }
+            Shader* indirect = indirectShaderFor(*head.shader);
+            if (indirect == nullptr || !drawIndirect(begin, end, *indirect, bound))
+                drawDirect(begin, end, bound);
+            begin = end;
+        }
+        if (blending)
+        {
+            GLState::setDepthMask(true);
+            GLState::setBlend(false);
+        }
+        packets.clear();
+        entries.clear();
+        materialIds.clear();
+    }
+
+    size_t size() const { return packets.size(); }
+    const RenderQueueStats& getStats() const { return stats; }
+
+    // the queue the primitives submit to, null to draw them immediately
+    static RenderQueue* current()
+    {
+        return currentQueue();
+    }
+
+    static void setCurrent(RenderQueue* queue)
+    {
+        currentQueue() = queue;
+    }
+
+private:
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    // what the last draw of the flush left bound
+    struct Bound
+    {
+        GLuint program = 0;
+        GLuint vao = 0;
+        uint32_t material = UINT32_MAX;     // none, or set by another program
+    };
+
+    static bool sameRun(const DrawPacket& head, const DrawPacket& packet)
+    {
+        return packet.shader->ID == head.shader->ID && packet.mesh->getVAO() == head.mesh->getVAO()
+            && packet.mesh->getIndexType() == head.mesh->getIndexType() && packet.transparent == head.transparent;
+    }
+
+    Shader* indirectShaderFor(const Shader& shader) const
+    {
+        for (const pair<unsigned int, Shader*>& entry : indirectShaders)
+        {
+            if (entry.first == shader.ID)
+                return entry.second;
+        }
+        return nullptr;
+    }
+
+    void bindProgram(Shader& shader, Bound& bound)
+    {
+        if (bound.program != shader.ID)
+        {
+            shader.use();
+            bound.program = shader.ID;
+            bound.material = UINT32_MAX;    // uniforms belong to the program, a new one needs the material again
+            ++stats.programChanges;
+        }
+    }
+
+    void bindVertexArray(const Mesh& mesh, Bound& bound)
+    {
+        if (bound.vao != mesh.getVAO())
+        {
+            mesh.getPool()->bind();
+            bound.vao = mesh.getVAO();
+            ++stats.vaoChanges;
+        }
+    }
+
+    // one draw per packet, the material index only when it changes
+    void drawDirect(size_t begin, size_t end, Bound& bound)
+    {
+        // a run has one program, its per draw uniforms are looked up once
+        const Shader& shader = *packets[entries[begin].packet].shader;
+        const GLint materialLocation = shader.uniformLocation("materialId");
+        const GLint modelLocation = shader.uniformLocation("model");
+        const GLint normalMatrixLocation = shader.uniformLocation("normalMatrix");
+        for (size_t i = begin; i < end; ++i)
+        {
+            const DrawPacket& packet = packets[entries[i].packet];
+            uint32_t materialId = materialIds[entries[i].packet];
+            bindProgram(*packet.shader, bound);
+            bindVertexArray(*packet.mesh, bound);
+            if (bound.material != materialId)
+            {
+                shader.setInt(materialLocation, (int)materialId);
+                bound.material = materialId;
+                ++stats.materialChanges;
+            }
+            shader.setMat4(modelLocation, packet.model);
+            shader.setMat3(normalMatrixLocation, normalMatrix(packet.model));
+            packet.mesh->draw();
+            ++stats.drawCalls;
+        }
+    }
+
+    // the whole run in one multi-draw, transforms and material indices read by gl_DrawIDARB;
+    // false (nothing drawn) once the frame's indirect buffers are full
+    bool drawIndirect(size_t begin, size_t end, Shader& indirect, Bound& bound)
+    {
+        commands.clear();
+        drawData.clear();
+        for (size_t i = begin; i < end; ++i)
+        {
+            const DrawPacket& packet = packets[entries[i].packet];
+            const Mesh& mesh = *packet.mesh;
+            size_t indexSize = mesh.getIndexType() == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+            DrawElementsIndirectCommand command = { mesh.getIndexCount(), 1, (GLuint)(mesh.getIndexOffset() / indexSize), mesh.getBaseVertex(), 0 };
+            commands.push_back(command);
+
+            const glm::mat3 normals = normalMatrix(packet.model);
+            DrawData data = { packet.model, { glm::vec4(normals[0], 0.0f), glm::vec4(normals[1], 0.0f), glm::vec4(normals[2], 0.0f) },
+                materialIds[entries[i].packet], { 0, 0, 0 } };
+            drawData.push_back(data);
+        }
+
+        StreamRange commandRange = commandStream->write(commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+        if (!commandRange.valid())
+            return false;
+        StreamRange dataRange = drawDataStream->write(drawData.data(), drawData.size() * sizeof(DrawData));
+        if (!dataRange.valid())
+            return false;
+
+        const Mesh& head = *packets[entries[begin].packet].mesh;
+        bindProgram(indirect, bound);
+        bindVertexArray(head, bound);
+        drawDataStream->bind(DRAW_DATA_BINDING, dataRange);
+        GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandStream->getBuffer());
+        GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, head.getIndexType(), (const void*)commandRange.offset, (GLsizei)commands.size(), 0);
+        ++stats.drawCalls;
+        return true;
+    }
+
+    uint64_t makeKey(const DrawPacket& packet, uint32_t materialId) const
+    {
+        const uint64_t depthMax = (1ull << RENDER_KEY_DEPTH_BITS) - 1;
+        float distance = -(view * packet.model * glm::vec4(packet.center, 1.0f)).z;
+        float normalized = distance / farPlane;
+        normalized = normalized < 0.0f ? 0.0f : (normalized > 1.0f ? 1.0f : normalized);
+        uint64_t depth = (uint64_t)(normalized * depthMax);
+
+        uint64_t state = ((uint64_t)(packet.shader->ID & 0xff) << (8 + RENDER_KEY_MATERIAL_BITS))
+            | ((uint64_t)(packet.mesh->getVAO() & 0xff) << RENDER_KEY_MATERIAL_BITS)
+            | (uint64_t)(materialId & ((1u << RENDER_KEY_MATERIAL_BITS) - 1));
+        const int stateBits = 16 + RENDER_KEY_MATERIAL_BITS;
+
+        if (!packet.transparent)
+            return (state << (RENDER_KEY_DEPTH_BITS + 11)) | (depth << 11);
+        return (1ull << 63) | ((depthMax - depth) << (stateBits + 11)) | (state << 11);
+    }
+
+    static unsigned int changesFrom(const DrawPacket* previous, uint32_t previousMaterial, const DrawPacket& packet, uint32_t materialId)
+    {
+        if (previous == nullptr)
+            return 3;
+        bool programChanged = previous->shader->ID != packet.shader->ID;
+        return (programChanged ? 1 : 0) + (previous->mesh->getVAO() != packet.mesh->getVAO() ? 1 : 0)
+            + (programChanged || previousMaterial != materialId ? 1 : 0);
+    }
+
+    // least significant byte first; stable, and a byte every key shares is skipped
+    static void radixSort(vector<SortEntry>& entries, vector<SortEntry>& scratch)
+    {
+        scratch.resize(entries.size());
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256];
+            memset(counts, 0, sizeof(counts));
+            for (const SortEntry& entry : entries)
+                ++counts[(entry.key >> shift) & 0xff];
+            if (counts[(entries[0].key >> shift) & 0xff] == entries.size())
+                continue;
+
+            size_t offset = 0;
+            for (size_t& count : counts)
+            {
+                size_t bucket = count;
+                count = offset;
+                offset += bucket;
+            }
+            for (const SortEntry& entry : entries)
+                scratch[counts[(entry.key >> shift) & 0xff]++] = entry;
+            entries.swap(scratch);
+        }
+    }
+
+    static RenderQueue*& currentQueue()
+    {
+        static RenderQueue* queue = nullptr;
+        return queue;
+    }
+
+    glm::mat4 view = glm::mat4(1.0f);
+    float farPlane = 100.0f;
+    vector<DrawPacket> packets;
+    vector<SortEntry> entries;
+    vector<SortEntry> scratch;
+    vector<uint32_t> materialIds;           // per packet, index into the material table
+    vector<pair<unsigned int, Shader*>> indirectShaders;     // program of the packets, its indirect variant
+    unique_ptr<StreamBuffer> commandStream; // DrawElementsIndirectCommand per draw, null without the indirect path
+    unique_ptr<StreamBuffer> drawDataStream;                 // DrawData per draw
+    vector<DrawElementsIndirectCommand> commands;
+    vector<DrawData> drawData;
+    RenderQueueStats stats;
+};
+
+#endif /* renderQueue_h */
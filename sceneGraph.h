@@ -0,0 +1,118 @@
+//
+//  sceneGraph.h
+//  hierarchy of local transforms with cached world matrices; only nodes whose
+//  local transform or one of whose ancestors changed are recomputed
+//
+
+#ifndef sceneGraph_h
+#define sceneGraph_h
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "matrixKernels.h"
+
+using namespace std;
+
+typedef unsigned int SceneNode;
+
+// parent of the top level nodes
+const int SCENE_NO_PARENT = -1;
+
+// node flags
+const uint8_t SCENE_NODE_DIRTY = 1;         // local transform set since the last update
+const uint8_t SCENE_NODE_CHANGED = 2;       // world matrix recomputed by the last update
+
+class SceneGraph
+{
+public:
+    // a parent is always added before its children, so one front to back pass over
+    // the arrays sees every parent's new world matrix before its children need it
+    SceneNode add(const glm::mat4& local, int parent = SCENE_NO_PARENT)
+    {
+        SceneNode node = (SceneNode)locals.size();
+        parents.push_back(parent);
+        locals.push_back(local);
+        worlds.push_back(local);
+        flags.push_back(SCENE_NODE_DIRTY);
+        return node;
+    }
+
+    SceneNode add(const glm::mat4& local, SceneNode parent)
+    {
+        return add(local, (int)parent);
+    }
+
+    // nothing is marked when the transform is unchanged
+    void setLocal(SceneNode node, const glm::mat4& local)
+    {
+        if (locals[node] == local)
+            return;
+        locals[node] = local;
+        flags[node] |= SCENE_NODE_DIRTY;
+    }
+
+    // world matrices of dirty nodes and everything below them; call once per frame
+    // after the setLocal() calls, before reading world()
+    void update()
+    {
+        recomputed = 0;
+        // consecutive nodes with the same parent are multiplied in one batch
+        size_t runStart = 0;
+        size_t runEnd = 0;
+        int runParent = SCENE_NO_PARENT;
+        const size_t count = locals.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const int parent = parents[i];
+            const bool parentChanged = parent != SCENE_NO_PARENT && (flags[parent] & SCENE_NODE_CHANGED) != 0;
+            if ((flags[i] & SCENE_NODE_DIRTY) == 0 && !parentChanged)
+            {
+                flags[i] = 0;
+                continue;
+            }
+            flags[i] = SCENE_NODE_CHANGED;
+            ++recomputed;
+            if (parent == SCENE_NO_PARENT)
+            {
+                worlds[i] = locals[i];
+                continue;
+            }
+            if (parent != runParent || i != runEnd)
+            {
+                // also flushed before a child of the run reads its parent's world matrix
+                flushRun(runParent, runStart, runEnd);
+                runParent = parent;
+                runStart = i;
+            }
+            runEnd = i + 1;
+        }
+        flushRun(runParent, runStart, runEnd);
+    }
+
+    const glm::mat4& world(SceneNode node) const { return worlds[node]; }
+    const glm::mat4& local(SceneNode node) const { return locals[node]; }
+
+    // whether the last update() gave the node a new world matrix
+    bool changed(SceneNode node) const { return (flags[node] & SCENE_NODE_CHANGED) != 0; }
+
+    size_t size() const { return locals.size(); }
+    // world matrices recomputed by the last update()
+    unsigned int getRecomputedCount() const { return recomputed; }
+
+private:
+    void flushRun(int parent, size_t start, size_t end)
+    {
+        if (end > start)
+            multiplyMatrices(worlds[parent], &locals[start], end - start, &worlds[start]);
+    }
+
+    // one array per field, the update pass streams through each front to back
+    vector<int> parents;
+    vector<glm::mat4> locals;
+    vector<glm::mat4> worlds;
+    vector<uint8_t> flags;
+    unsigned int recomputed = 0;
+};
+
+#endif /* sceneGraph_h */
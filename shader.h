@@ -8,15 +8,37 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "assetPack.h"
+#include "glExtensions.h"
+#include "glState.h"
+#include "uniformName.h"
 
 class Shader
 {
 public:
     unsigned int ID;
+    // whether every stage compiled and the program linked
+    bool linked = false;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
     {
+        // 0. sources baked into the current asset pack compile straight from the mapped file
+        const AssetPack* pack = AssetPack::current();
+        if (pack != nullptr && geometryPath == nullptr)
+        {
+            const AssetPackEntry* vertexEntry = pack->findShader(vertexPath);
+            const AssetPackEntry* fragmentEntry = pack->findShader(fragmentPath);
+            if (vertexEntry != nullptr && fragmentEntry != nullptr)
+            {
+                compile((const char*)pack->data(*vertexEntry), (GLint)vertexEntry->dataBytes,
+                    (const char*)pack->data(*fragmentEntry), (GLint)fragmentEntry->dataBytes, nullptr, 0);
+                return;
+            }
+        }
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
@@ -57,111 +79,265 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if (geometryPath != nullptr)
-        {
-            const char* gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
-        }
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
-            glDeleteShader(geometry);
-
+        compile(vertexCode.c_str(), (GLint)vertexCode.size(), fragmentCode.c_str(), (GLint)fragmentCode.size(),
+            geometryPath != nullptr ? geometryCode.c_str() : nullptr, (GLint)geometryCode.size());
     }
-    // activate the shader
+    // activate the shader, skipped when it already is
     // ------------------------------------------------------------------------
     void use()
     {
-        glUseProgram(ID);
+        GLState::useProgram(ID);
     }
-    // utility uniform functions
+    // location of an active uniform from the table built at link time, -1 (ignored by
+    // the GL like any unknown name) when the program has no such uniform
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    GLint uniformLocation(UniformName name) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        std::vector<ReflectedUniform>::const_iterator found = std::lower_bound(uniforms.begin(), uniforms.end(), name.hash,
+            [](const ReflectedUniform& uniform, uint32_t hash) { return uniform.hash < hash; });
+        return found != uniforms.end() && found->hash == name.hash ? found->location : -1;
     }
+    // utility uniform functions, by name or by a location from uniformLocation(); with
+    // glProgramUniform (GL 4.1) the program is written without binding it, otherwise it
+    // is made current first. Per draw code resolves the location once and passes that
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setBool(UniformName name, bool value) const
+    {
+        setInt(name, (int)value);
+    }
+    void setBool(GLint location, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(location, (int)value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setInt(UniformName name, int value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(uniformLocation(name), value);
+    }
+    void setInt(GLint location, int value) const
+    {
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniform1i(ID, location, value);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniform1i(location, value);
+        }
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setFloat(UniformName name, float value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setFloat(uniformLocation(name), value);
     }
-    void setVec2(const std::string& name, float x, float y) const
+    void setFloat(GLint location, float value) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniform1f(ID, location, value);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniform1f(location, value);
+        }
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setVec2(UniformName name, const glm::vec2& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        setVec2(uniformLocation(name), value);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void setVec2(GLint location, const glm::vec2& value) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniform2fv(ID, location, 1, &value[0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniform2fv(location, 1, &value[0]);
+        }
+    }
+    void setVec2(UniformName name, float x, float y) const
+    {
+        setVec2(name, glm::vec2(x, y));
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec3(UniformName name, const glm::vec3& value) const
+    {
+        setVec3(uniformLocation(name), value);
+    }
+    void setVec3(GLint location, const glm::vec3& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniform3fv(ID, location, 1, &value[0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniform3fv(location, 1, &value[0]);
+        }
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w)
+    void setVec3(UniformName name, float x, float y, float z) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        setVec3(name, glm::vec3(x, y, z));
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setVec4(UniformName name, const glm::vec4& value) const
+    {
+        setVec4(uniformLocation(name), value);
+    }
+    void setVec4(GLint location, const glm::vec4& value) const
+    {
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniform4fv(ID, location, 1, &value[0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniform4fv(location, 1, &value[0]);
+        }
+    }
+    void setVec4(UniformName name, float x, float y, float z, float w) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setVec4(name, glm::vec4(x, y, z, w));
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat2(UniformName name, const glm::mat2& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(uniformLocation(name), mat);
+    }
+    void setMat2(GLint location, const glm::mat2& mat) const
+    {
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniformMatrix2fv(ID, location, 1, GL_FALSE, &mat[0][0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+        }
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat3(UniformName name, const glm::mat3& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(uniformLocation(name), mat);
+    }
+    void setMat3(GLint location, const glm::mat3& mat) const
+    {
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniformMatrix3fv(ID, location, 1, GL_FALSE, &mat[0][0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(UniformName name, const glm::mat4& mat) const
+    {
+        setMat4(uniformLocation(name), mat);
+    }
+    void setMat4(GLint location, const glm::mat4& mat) const
+    {
+        if (GLExtensions::hasProgramUniform())
+            GLExtensions::programUniformMatrix4fv(ID, location, 1, GL_FALSE, &mat[0][0]);
+        else
+        {
+            GLState::useProgram(ID);
+            glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+        }
+    }
+    // ------------------------------------------------------------------------
+    // GLSL 330 has no layout(binding), the block is tied to its binding point here
+    void bindUniformBlock(const std::string& name, unsigned int binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
     }
 
 private:
+    // compiles and links the program from sources of the given lengths, geometryCode may be null
+    // ------------------------------------------------------------------------
+    void compile(const char* vShaderCode, GLint vLength, const char* fShaderCode, GLint fLength, const char* gShaderCode, GLint gLength)
+    {
+        unsigned int vertex, fragment;
+        // vertex shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, &vLength);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+        // fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, &fLength);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+        // if geometry shader is given, compile geometry shader
+        unsigned int geometry;
+        if (gShaderCode != nullptr)
+        {
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &gShaderCode, &gLength);
+            glCompileShader(geometry);
+            checkCompileErrors(geometry, "GEOMETRY");
+        }
+        // shader Program
+        ID = glCreateProgram();
+        glAttachShader(ID, vertex);
+        glAttachShader(ID, fragment);
+        if (gShaderCode != nullptr)
+            glAttachShader(ID, geometry);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        GLint status = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &status);
+        linked = status != 0;
+        reflectUniforms();
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (gShaderCode != nullptr)
+            glDeleteShader(geometry);
+    }
+    // every active uniform outside a block, arrays also under "name" and each "name[i]"
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniforms.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> buffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            // members of uniform blocks have no location
+            if (location < 0)
+                continue;
+            addUniform(name, location);
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = name.substr(0, name.size() - 3);
+                addUniform(base, location);
+                for (GLint element = 1; element < size; ++element)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    addUniform(elementName, glGetUniformLocation(ID, elementName.c_str()));
+                }
+            }
+        }
+        std::sort(uniforms.begin(), uniforms.end(),
+            [](const ReflectedUniform& a, const ReflectedUniform& b) { return a.hash < b.hash; });
+        for (size_t i = 1; i < uniforms.size(); ++i)
+        {
+            if (uniforms[i].hash == uniforms[i - 1].hash)
+                std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION at locations " << uniforms[i - 1].location << " and " << uniforms[i].location << std::endl;
+        }
+    }
+    void addUniform(const std::string& name, GLint location)
+    {
+        ReflectedUniform uniform = { uniformHash(name.data(), name.size()), location };
+        uniforms.push_back(uniform);
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -187,6 +363,37 @@ private:
             }
         }
     }
+
+    struct ReflectedUniform
+    {
+        uint32_t hash;
+        GLint location;
+    };
+    // sorted by hash
+    std::vector<ReflectedUniform> uniforms;
+};
+
+// a uniform's location, looked up when first used with a program and again only when
+// the program changes; for members of objects that set the same uniform every frame
+class UniformHandle
+{
+public:
+    explicit UniformHandle(UniformName name) : name(name) {}
+
+    GLint get(const Shader& shader)
+    {
+        if (shader.ID != program)
+        {
+            program = shader.ID;
+            location = shader.uniformLocation(name);
+        }
+        return location;
+    }
+
+private:
+    UniformName name;
+    unsigned int program = 0;
+    GLint location = -1;
 };
 #endif
 
@@ -9,7 +9,7 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "shader.h"
+#include "lightBlock.h"
 
 class SpotLight {
 public:
@@ -38,21 +38,19 @@ public:
         k_q = quadratic;
         
     }
-    void setUpSpotLight(Shader& lightingShader)
+    void setUpSpotLight(LightBlock& lights) const
     {
-        lightingShader.use();
-
-        
-            lightingShader.setVec3("spotLight.position", position);
-            lightingShader.setVec3("spotLight.ambient", ambientOn * ambient);
-            lightingShader.setVec3("spotLight.diffuse", diffuseOn * diffuse);
-            lightingShader.setVec3("spotLight.specular", specularOn * specular);
-            lightingShader.setVec3("spotLight.direction",  direction);
-            lightingShader.setFloat("spotLight.cos_theta", cos_theta);
-            lightingShader.setFloat("spotLight.k_c", k_c);
-            lightingShader.setFloat("spotLight.k_l", k_l);
-            lightingShader.setFloat("spotLight.k_q", k_q);
-       
+        SpotLightUniform light = {};
+        light.position = position;
+        light.ambient = ambientOn * ambient;
+        light.diffuse = diffuseOn * diffuse;
+        light.specular = specularOn * specular;
+        light.direction = direction;
+        light.cos_theta = cos_theta;
+        light.k_c = k_c;
+        light.k_l = k_l;
+        light.k_q = k_q;
+        lights.setSpotLight(light);
     }
     void turnOff()
     {
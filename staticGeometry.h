@@ -0,0 +1,150 @@
+//
+//  staticGeometry.h
+//  scenery that never moves, transformed into world space once and merged
+//  into one vertex buffer; every vertex carries the index of its material
+//
+
+#ifndef staticGeometry_h
+#define staticGeometry_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mesh.h"
+#include "shader.h"
+#include "glState.h"
+#include "materialTable.h"
+#include "transform.h"
+#include "frustum.h"
+
+using namespace std;
+
+struct StaticVertex
+{
+    float position[3];                      // world space
+    float normal[3];
+    GLuint material;                        // into the Materials block
+};
+
+class StaticGeometry
+{
+public:
+    StaticGeometry() {}
+
+    ~StaticGeometry()
+    {
+        release();
+    }
+
+    StaticGeometry(const StaticGeometry&) = delete;
+    StaticGeometry& operator=(const StaticGeometry&) = delete;
+
+    // appends mesh transformed by model; only before upload()
+    void add(const Mesh& mesh, const glm::mat4& model, const MaterialState& material)
+    {
+        MaterialTable* table = MaterialTable::current();
+        GLuint materialId = table != nullptr ? table->intern(material) : 0;
+        const glm::mat3 normals = normalMatrix(model);
+        const float* in = mesh.getVertices();
+        const int floatStride = mesh.getVerticesStride() / sizeof(float);
+        const GLuint first = (GLuint)vertices.size();
+
+        for (unsigned int i = 0; i < mesh.getVertexCount(); ++i, in += floatStride)
+        {
+            glm::vec3 position = glm::vec3(model * glm::vec4(in[0], in[1], in[2], 1.0f));
+            glm::vec3 normal = glm::normalize(normals * glm::vec3(in[3], in[4], in[5]));
+            boundsBuilder.add(position.x, position.y, position.z);
+            StaticVertex vertex = { { position.x, position.y, position.z }, { normal.x, normal.y, normal.z }, materialId };
+            vertices.push_back(vertex);
+        }
+        const unsigned int* meshIndices = mesh.getIndices();
+        for (unsigned int i = 0; i < mesh.getIndexCount(); ++i)
+            indices.push_back(first + meshIndices[i]);
+    }
+
+    // moves everything added into GL buffers and drops the host copies
+    void upload()
+    {
+        release();
+        if (indices.empty())
+            return;
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        GLState::bindVertexArray(VAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(StaticVertex), vertices.data(), GL_STATIC_DRAW);
+        GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(StaticVertex), (void*)offsetof(StaticVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(StaticVertex), (void*)offsetof(StaticVertex, normal));
+        glEnableVertexAttribArray(MATERIAL_ID_LOCATION);
+        glVertexAttribIPointer(MATERIAL_ID_LOCATION, 1, GL_UNSIGNED_INT, sizeof(StaticVertex), (void*)offsetof(StaticVertex, material));
+
+        vertexCount = (unsigned int)vertices.size();
+        indexCount = (unsigned int)indices.size();
+        bounds = boundsBuilder.build();
+        vector<StaticVertex>().swap(vertices);
+        vector<GLuint>().swap(indices);
+    }
+
+    // the whole baked scene in one draw, with the shader's baked path; culled as one object
+    void draw(Shader& shader) const
+    {
+        if (VAO == 0 || !FrustumCulling::isVisible(bounds, glm::mat4(1.0f)))
+            return;
+        shader.use();
+        const GLint baked = bakedUniform.get(shader);
+        const GLint instanced = instancedUniform.get(shader);
+        shader.setBool(baked, true);
+        shader.setBool(instanced, true);
+        GLState::bindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, (void*)0);
+        shader.setBool(baked, false);
+        shader.setBool(instanced, false);
+    }
+
+    // free the GL objects; safe to call more than once
+    void release()
+    {
+        if (VAO != 0)
+        {
+            GLState::forgetVertexArray(VAO);
+            GLState::forgetBuffer(VBO);
+            GLState::forgetBuffer(EBO);
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
+        }
+        VAO = VBO = EBO = 0;
+        vertexCount = 0;
+        indexCount = 0;
+    }
+
+    unsigned int getVertexCount() const { return vertexCount; }
+    unsigned int getIndexCount() const { return indexCount; }
+    // world space box and sphere of everything baked
+    const Bounds& getBounds() const { return bounds; }
+
+private:
+    vector<StaticVertex> vertices;
+    vector<GLuint> indices;
+    BoundsBuilder boundsBuilder;
+    Bounds bounds;
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    // draw() is const, the locations are only a cache
+    mutable UniformHandle bakedUniform = UniformHandle("bakedGeometry");
+    mutable UniformHandle instancedUniform = UniformHandle("instanced");
+};
+
+#endif /* staticGeometry_h */
@@ -0,0 +1,169 @@
+//
+//  streamBuffer.h
+//  ring buffer for data rewritten every frame: persistently mapped where the
+//  context has buffer storage, one region per frame in flight guarded by a fence
+//
+
+#ifndef streamBuffer_h
+#define streamBuffer_h
+
+#include <glad/glad.h>
+#include <cstring>
+#include <iostream>
+#include "glExtensions.h"
+#include "glState.h"
+
+using namespace std;
+
+// frames the CPU may run ahead of the GPU before beginFrame() waits
+const int STREAM_FRAMES_IN_FLIGHT = 3;
+
+// where a write() landed, to bind it by offset
+struct StreamRange
+{
+    GLintptr offset = 0;
+    GLsizeiptr size = 0;                    // 0 if the frame region was full
+
+    bool valid() const { return size > 0; }
+};
+
+class StreamBuffer
+{
+public:
+    // frameBytes is the most one frame may write, alignment padding included
+    StreamBuffer(GLenum target, size_t frameBytes) : target(target), frameBytes(frameBytes)
+    {
+        GLint offsetAlignment = 16;
+        if (target == GL_UNIFORM_BUFFER)
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+        else if (target == GL_SHADER_STORAGE_BUFFER)
+            glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+        alignment = offsetAlignment > 0 ? offsetAlignment : 16;
+        this->frameBytes = (frameBytes + alignment - 1) / alignment * alignment;
+        const size_t totalBytes = this->frameBytes * STREAM_FRAMES_IN_FLIGHT;
+
+        glGenBuffers(1, &buffer);
+        GLState::bindBuffer(target, buffer);
+        if (GLExtensions::hasBufferStorage())
+        {
+            // coherent, so plain stores are visible to the GPU without flushing
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GLExtensions::bufferStorage(target, totalBytes, nullptr, flags);
+            mapped = (unsigned char*)glMapBufferRange(target, 0, totalBytes, flags);
+        }
+        if (mapped == nullptr)
+            glBufferData(target, totalBytes, nullptr, GL_STREAM_DRAW);
+    }
+
+    ~StreamBuffer()
+    {
+        release();
+    }
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // moves to the next frame region, waiting if the GPU still reads it
+    void beginFrame()
+    {
+        frame = (frame + 1) % STREAM_FRAMES_IN_FLIGHT;
+        GLsync& fence = fences[frame];
+        if (fence != nullptr)
+        {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+            {
+                ++stalls;
+                while (status == GL_TIMEOUT_EXPIRED)
+                    status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        cursor = 0;
+    }
+
+    // fences the region written this frame, call after its last draw
+    void endFrame()
+    {
+        if (fences[frame] == nullptr)
+            fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // copies bytes into the current frame region; straight into the mapping when persistent
+    StreamRange write(const void* data, size_t bytes)
+    {
+        StreamRange range;
+        if (cursor + bytes > frameBytes)
+        {
+            if (!overflowReported)
+                cout << "stream buffer: frame region of " << frameBytes << " bytes is full" << endl;
+            overflowReported = true;
+            return range;
+        }
+
+        range.offset = (GLintptr)(frame * frameBytes + cursor);
+        range.size = (GLsizeiptr)bytes;
+        if (mapped != nullptr)
+            memcpy(mapped + range.offset, data, bytes);
+        else
+        {
+            GLState::bindBuffer(target, buffer);
+            glBufferSubData(target, range.offset, range.size, data);
+        }
+        cursor = (cursor + bytes + alignment - 1) / alignment * alignment;
+        return range;
+    }
+
+    // binds a written range to an indexed binding point (uniform block or storage block binding)
+    void bind(GLuint binding, const StreamRange& range) const
+    {
+        if (range.valid())
+            GLState::bindBufferRange(target, binding, buffer, range.offset, range.size);
+    }
+
+    // free the GL objects; safe to call more than once
+    void release()
+    {
+        for (GLsync& fence : fences)
+        {
+            if (fence != nullptr)
+                glDeleteSync(fence);
+            fence = nullptr;
+        }
+        if (buffer != 0)
+        {
+            if (mapped != nullptr)
+            {
+                GLState::bindBuffer(target, buffer);
+                glUnmapBuffer(target);
+            }
+            GLState::forgetBuffer(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+        mapped = nullptr;
+    }
+
+    bool isPersistent() const { return mapped != nullptr; }
+    unsigned int getBuffer() const { return buffer; }
+    GLenum getTarget() const { return target; }
+    size_t getFrameBytes() const { return frameBytes; }
+    size_t getAlignment() const { return alignment; }
+    // frames that had to wait for the GPU in beginFrame()
+    unsigned int getStallCount() const { return stalls; }
+
+private:
+    GLenum target;
+    size_t frameBytes;
+    size_t alignment = 16;
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;        // whole buffer, null when falling back to glBufferSubData
+    GLsync fences[STREAM_FRAMES_IN_FLIGHT] = {};
+    int frame = STREAM_FRAMES_IN_FLIGHT - 1;
+    size_t cursor = 0;                      // bytes used in the current region
+    unsigned int stalls = 0;
+    bool overflowReported = false;
+};
+
+#endif /* streamBuffer_h */
@@ -0,0 +1,99 @@
+//
+//  threadPool.h
+//  fixed set of worker threads for CPU work that never touches GL
+//
+
+#ifndef threadPool_h
+#define threadPool_h
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned int threadCount)
+    {
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    // finishes the queued tasks, then joins
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // runs task on a worker, the future holds its result (or its exception)
+    template <typename Task>
+    auto submit(Task task) -> future<decltype(task())>
+    {
+        typedef decltype(task()) Result;
+        shared_ptr<packaged_task<Result()>> packaged = make_shared<packaged_task<Result()>>(std::move(task));
+        future<Result> result = packaged->get_future();
+        {
+            lock_guard<mutex> lock(queueMutex);
+            tasks.push_back([packaged]() { (*packaged)(); });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    unsigned int size() const { return (unsigned int)workers.size(); }
+
+    // one worker per core, minus the main thread; started on first use
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool(defaultThreadCount());
+        return pool;
+    }
+
+    static unsigned int defaultThreadCount()
+    {
+        unsigned int cores = thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+private:
+    void work()
+    {
+        for (;;)
+        {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(queueMutex);
+                wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex queueMutex;
+    condition_variable wake;
+    bool stopping = false;
+};
+
+#endif /* threadPool_h */
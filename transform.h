@@ -0,0 +1,33 @@
+//
+//  transform.h
+//  per-object transform helpers for the CPU side of the vertex shaders
+//
+
+#ifndef transform_h
+#define transform_h
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+// relative tolerance for treating the basis of a transform as orthogonal with one scale
+const float UNIFORM_SCALE_TOLERANCE = 1e-4f;
+
+// transpose(inverse()) of the upper 3x3, what the shaders multiply normals by. Rotations
+// with one scale on all axes only change a normal's length, which the shaders normalize
+// away, so for those the matrix itself is returned and the inverse skipped
+inline glm::mat3 normalMatrix(const glm::mat4& model)
+{
+    const glm::mat3 basis(model);
+    const float xx = glm::dot(basis[0], basis[0]);
+    const float yy = glm::dot(basis[1], basis[1]);
+    const float zz = glm::dot(basis[2], basis[2]);
+    const float tolerance = UNIFORM_SCALE_TOLERANCE * (xx + yy + zz);
+    if (std::fabs(xx - yy) <= tolerance && std::fabs(yy - zz) <= tolerance
+        && std::fabs(glm::dot(basis[0], basis[1])) <= tolerance
+        && std::fabs(glm::dot(basis[1], basis[2])) <= tolerance
+        && std::fabs(glm::dot(basis[0], basis[2])) <= tolerance)
+        return basis;
+    return glm::transpose(glm::inverse(basis));
+}
+
+#endif /* transform_h */
@@ -0,0 +1,111 @@
+//
+//  transformBenchmark.h
+//  times the batched matrix kernels against glm's mat4 product on as many
+//  transforms as a large scene updates per frame; run with --bench-transforms
+//
+
+#ifndef transformBenchmark_h
+#define transformBenchmark_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "matrixKernels.h"
+
+using namespace std;
+
+const unsigned int TRANSFORM_BENCHMARK_OBJECTS = 10000;
+const unsigned int TRANSFORM_BENCHMARK_ROUNDS = 200;      // the fastest round is reported
+
+class TransformBenchmark
+{
+public:
+    static void run(unsigned int objects = TRANSFORM_BENCHMARK_OBJECTS)
+    {
+        objects = max(objects, 1u);
+        // translate * rotate * scale, built the way the draw helpers build theirs
+        vector<glm::mat4> parents(objects), locals(objects);
+        for (unsigned int i = 0; i < objects; ++i)
+        {
+            parents[i] = objectTransform(i, 3.0f);
+            locals[i] = objectTransform(i * 7 + 1, 0.5f);
+        }
+
+        vector<glm::mat4> reference(objects), pairwise(objects), shared(objects);
+        double glmSeconds = fastestRound([&]() {
+            for (unsigned int i = 0; i < objects; ++i)
+                reference[i] = parents[i] * locals[i];
+        });
+        double pairwiseSeconds = fastestRound([&]() {
+            multiplyMatrices(parents.data(), locals.data(), objects, pairwise.data());
+        });
+        double sharedSeconds = fastestRound([&]() {
+            multiplyMatrices(parents[0], locals.data(), objects, shared.data());
+        });
+
+        float difference = 0.0f;
+        for (unsigned int i = 0; i < objects; ++i)
+        {
+            difference = max(difference, maxDifference(reference[i], pairwise[i]));
+            difference = max(difference, maxDifference(parents[0] * locals[i], shared[i]));
+        }
+
+        cout << "transform benchmark: " << objects << " matrices, " << matrixKernelName()
+            << " kernels, fastest of " << TRANSFORM_BENCHMARK_ROUNDS << " rounds" << endl;
+        report("glm mat4 * mat4", glmSeconds, objects, glmSeconds);
+        report("kernel, parent per matrix", pairwiseSeconds, objects, glmSeconds);
+        report("kernel, one parent", sharedSeconds, objects, glmSeconds);
+        cout << "  largest difference from glm: " << difference << endl;
+    }
+
+private:
+    static glm::mat4 objectTransform(unsigned int seed, float extent)
+    {
+        float t = (float)(seed % 1000) / 1000.0f;
+        glm::mat4 identityMatrix = glm::mat4(1.0f);
+        glm::mat4 translateMatrix = glm::translate(identityMatrix, glm::vec3(extent * t, extent * (1.0f - t), -extent * t));
+        glm::mat4 rotateMatrix = glm::rotate(identityMatrix, glm::radians(360.0f * t), glm::vec3(0.3f, 1.0f, 0.2f));
+        glm::mat4 scaleMatrix = glm::scale(identityMatrix, glm::vec3(0.5f + t, 1.0f, 1.5f - t));
+        return translateMatrix * rotateMatrix * scaleMatrix;
+    }
+
+    template <typename Pass>
+    static double fastestRound(Pass pass)
+    {
+        double fastest = 1e30;
+        for (unsigned int round = 0; round < TRANSFORM_BENCHMARK_ROUNDS; ++round)
+        {
+            auto start = chrono::steady_clock::now();
+            pass();
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            fastest = min(fastest, elapsed.count());
+        }
+        return fastest;
+    }
+
+    static float maxDifference(const glm::mat4& a, const glm::mat4& b)
+    {
+        float difference = 0.0f;
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+                difference = max(difference, fabsf(a[column][row] - b[column][row]));
+        }
+        return difference;
+    }
+
+    static void report(const char* name, double seconds, unsigned int objects, double glmSeconds)
+    {
+        cout << "  " << name << ": " << seconds * 1e9 / objects << " ns per matrix, "
+            << seconds * 1e3 << " ms per frame";
+        if (seconds > 0.0)
+            cout << ", " << glmSeconds / seconds << "x glm";
+        cout << endl;
+    }
+};
+
+#endif /* transformBenchmark_h */
@@ -0,0 +1,111 @@
+//
+//  uniformBlocks.h
+//  std140 uniform blocks shared by the shaders, and their binding points
+//
+
+#ifndef uniformBlocks_h
+#define uniformBlocks_h
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// binding points, the same for every program
+const unsigned int FRAME_BLOCK_BINDING = 0;
+const unsigned int MATERIAL_BLOCK_BINDING = 1;
+const unsigned int LIGHT_BLOCK_BINDING = 2;
+// storage block bindings are numbered apart from the uniform block ones
+const unsigned int DRAW_DATA_BINDING = 0;
+
+// layout (std140) uniform FrameData in the shaders: camera of the current frame
+struct FrameUniforms
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPos;
+    float padding;                          // vec3 takes a full 16 byte slot in std140
+};
+
+static_assert(sizeof(FrameUniforms) == 144, "FrameUniforms must match the std140 FrameData block");
+
+// layout (std140) uniform Materials: every material of the scene, indexed by material id;
+// 256 entries are 16 KB, the smallest uniform block size the GL has to support
+const unsigned int MATERIAL_COUNT = 256;
+
+struct MaterialUniform
+{
+    glm::vec4 ambient;                      // rgb, a unused
+    glm::vec4 diffuse;                      // rgb, a unused
+    glm::vec4 specular;                     // rgb specular, a the shininess
+    glm::vec4 emissive;                     // rgb, a unused
+};
+
+static_assert(sizeof(MaterialUniform) == 64, "MaterialUniform must match the std140 MaterialEntry struct");
+
+// one element of the std430 DrawDataBuffer of the indirect shaders, indexed by gl_DrawIDARB
+struct DrawData
+{
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];              // mat3 columns, each padded to 16 bytes
+    GLuint material;                        // into the Materials block
+    GLuint padding[3];                      // the struct is rounded up to the mat4's 16 byte alignment
+};
+
+static_assert(sizeof(DrawData) == 128, "DrawData must match the std430 DrawData struct");
+
+// layout (std140) uniform Lights: every light of the scene, the same for all lighting programs.
+// each vec3 is followed by a float so the two share one 16 byte slot, as std140 packs them
+const unsigned int MAX_POINT_LIGHTS = 4;
+
+struct PointLightUniform
+{
+    glm::vec3 position;
+    float k_c;
+    glm::vec3 ambient;
+    float k_l;
+    glm::vec3 diffuse;
+    float k_q;
+    glm::vec3 specular;
+    float padding;
+};
+
+struct SpotLightUniform
+{
+    glm::vec3 position;
+    float cos_theta;
+    glm::vec3 direction;
+    float k_c;
+    glm::vec3 ambient;
+    float k_l;
+    glm::vec3 diffuse;
+    float k_q;
+    glm::vec3 specular;
+    float padding;
+};
+
+struct DirectionalLightUniform
+{
+    glm::vec3 ambient;
+    float padding0;
+    glm::vec3 diffuse;
+    float padding1;
+    glm::vec3 specular;
+    float padding2;
+    glm::vec3 direction;
+    float padding3;
+};
+
+struct LightUniforms
+{
+    PointLightUniform pointLights[MAX_POINT_LIGHTS];
+    SpotLightUniform spotLight;
+    DirectionalLightUniform directionalLight;
+    int pointLightCount;
+    int padding[3];
+};
+
+static_assert(sizeof(PointLightUniform) == 64, "PointLightUniform must match the std140 PointLight struct");
+static_assert(sizeof(SpotLightUniform) == 80, "SpotLightUniform must match the std140 SpotLight struct");
+static_assert(sizeof(DirectionalLightUniform) == 64, "DirectionalLightUniform must match the std140 DiectionalLight struct");
+static_assert(sizeof(LightUniforms) == 416, "LightUniforms must match the std140 Lights block");
+
+#endif /* uniformBlocks_h */
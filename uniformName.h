@@ -0,0 +1,42 @@
+//
+//  uniformName.h
+//  uniform names reduced to a 32-bit FNV-1a hash, without allocating. Only a
+//  constexpr UniformName is hashed at compile time, a literal passed to set*() is
+//  hashed on every call; per draw code passes locations (Shader, UniformHandle)
+//
+
+#ifndef uniformName_h
+#define uniformName_h
+
+#include <cstdint>
+#include <string>
+
+const uint32_t UNIFORM_HASH_BASIS = 2166136261u;
+const uint32_t UNIFORM_HASH_PRIME = 16777619u;
+
+constexpr uint32_t uniformHash(const char* text, size_t length)
+{
+    uint32_t hash = UNIFORM_HASH_BASIS;
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ (uint8_t)text[i]) * UNIFORM_HASH_PRIME;
+    return hash;
+}
+
+constexpr uint32_t uniformHash(const char* text)
+{
+    uint32_t hash = UNIFORM_HASH_BASIS;
+    for (; *text != '\0'; ++text)
+        hash = (hash ^ (uint8_t)*text) * UNIFORM_HASH_PRIME;
+    return hash;
+}
+
+struct UniformName
+{
+    // implicit, so setMat4("model", ...) keeps working unchanged
+    constexpr UniformName(const char* text) : hash(uniformHash(text)) {}
+    UniformName(const std::string& text) : hash(uniformHash(text.data(), text.size())) {}
+
+    uint32_t hash;
+};
+
+#endif /* uniformName_h */
@@ -0,0 +1,112 @@
+//
+//  vertexFormat.h
+//  GPU vertex layouts and the conversions into and out of the compact one
+//
+
+#ifndef vertexFormat_h
+#define vertexFormat_h
+
+#include <cstdint>
+#include <cstring>
+
+enum VertexFormat
+{
+    VERTEX_FLOAT,       // float3 position + float3 normal, 24 bytes
+    VERTEX_COMPACT      // half3 position (+ 2 bytes padding) + 2_10_10_10 normal, 12 bytes
+};
+
+const int COMPACT_VERTEX_STRIDE = 12;
+const int COMPACT_NORMAL_OFFSET = 8;
+
+// float to IEEE half, rounding to nearest even; out of range values saturate to infinity
+inline uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (((bits >> 23) & 0xff) == 0xff)                 // inf / nan
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+    if (exponent >= 31)                                 // too large
+        return sign | 0x7c00;
+    if (exponent <= 0)                                  // subnormal or zero
+    {
+        if (exponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1)))
+            ++half;
+        return sign | (uint16_t)half;
+    }
+
+    uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        ++half;                                         // may carry into the exponent, which is still correct
+    return sign | (uint16_t)half;
+}
+
+inline float halfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0x1f)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    else if (mantissa == 0)
+        bits = sign;
+    else
+    {
+        // subnormal half, renormalize
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// unit normal into GL_INT_2_10_10_10_REV, x in the low bits, w left 0
+inline uint32_t packNormal(float x, float y, float z)
+{
+    const float components[3] = { x, y, z };
+    uint32_t packed = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        float c = components[i] < -1.0f ? -1.0f : (components[i] > 1.0f ? 1.0f : components[i]);
+        int32_t q = (int32_t)(c * 511.0f + (c < 0.0f ? -0.5f : 0.5f));
+        packed |= ((uint32_t)q & 0x3ff) << (10 * i);
+    }
+    return packed;
+}
+
+inline void unpackNormal(uint32_t packed, float* normal)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        int32_t q = (int32_t)((packed >> (10 * i)) & 0x3ff);
+        if (q & 0x200)
+            q -= 0x400;                                 // sign extend the 10 bit value
+        float c = q / 511.0f;
+        normal[i] = c < -1.0f ? -1.0f : c;
+    }
+}
+
+#endif /* vertexFormat_h */
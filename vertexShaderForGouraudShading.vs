@@ -1,12 +1,33 @@
 #version 330 core
+// VERTEX_COMPACT meshes store half float positions and 2_10_10_10 normals,
+// the attribute fetch expands both to the float vectors below
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
+// per-instance model matrix of the instanced cube draw
+layout (location = 2) in mat4 aInstanceModel;
+// material index, per instance or, in the baked static geometry, per vertex
+layout (location = 9) in uint aMaterialId;
+// per-instance normal matrix, computed on the CPU next to the model matrix
+layout (location = 10) in mat3 aInstanceNormalMatrix;
 
 out vec4 LightingColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// transpose(inverse(mat3(model))) of single draws, see transform.h
+uniform mat3 normalMatrix;
+// material of single draws, an index into the Materials block
+uniform int materialId = 0;
+// true: model, normal matrix and material index come from the instance attributes instead of the uniforms
+uniform bool instanced = false;
+// true: already in world space (the material index still comes from the attribute)
+uniform bool bakedGeometry = false;
+// camera, written once per frame into the stream buffer
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
 
 struct Material {
     vec3 ambient;
@@ -15,34 +36,71 @@ struct Material {
     float shininess;
 };
 
+// light structs of the Lights block, laid out as in fragmentShaderForPhongShading.fs
+struct DiectionalLight {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    vec3 direction;
+};
+
 struct PointLight {
     vec3 position;
-    
     float k_c;  // attenuation factors
+    vec3 ambient;
     float k_l;  // attenuation factors
+    vec3 diffuse;
     float k_q;  // attenuation factors
-    
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    float cos_theta;
+    vec3 direction;
+    float k_c;  // attenuation factors
     vec3 ambient;
+    float k_l;  // attenuation factors
     vec3 diffuse;
+    float k_q;  // attenuation factors
     vec3 specular;
 };
 
+#define MAX_POINT_LIGHTS 4
 
-#define NR_POINT_LIGHTS 4
-
-uniform vec3 viewPos;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform Material material;
+// the same block as the Phong shader; only the point lights are used here
+layout (std140) uniform Lights
+{
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    SpotLight spotLight;
+    DiectionalLight diectionalLight;
+    int pointLightCount;
+};
+// every material of the scene, see materialTable.h
+struct MaterialEntry {
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;      // shininess in w
+    vec4 emissive;
+};
+layout (std140) uniform Materials
+{
+    MaterialEntry materials[256];
+};
 
 // function prototypes
 vec3 CalcPointLight(Material material, PointLight light, vec3 N, vec3 Pos, vec3 V);
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    mat4 M = bakedGeometry ? mat4(1.0) : (instanced ? aInstanceModel : model);
+    gl_Position = projection * view * M * vec4(aPos, 1.0);
     
-    vec3 Pos = vec3(model * vec4(aPos, 1.0));
-    vec3 Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec3 Pos = vec3(M * vec4(aPos, 1.0));
+    vec3 Normal = (bakedGeometry ? mat3(1.0) : (instanced ? aInstanceNormalMatrix : normalMatrix)) * aNormal;
+
+    MaterialEntry entry = materials[instanced ? aMaterialId : uint(materialId)];
+    Material m = Material(entry.ambient.rgb, entry.diffuse.rgb, entry.specular.rgb, entry.specular.a);
     
     // properties
     vec3 N = normalize(Normal);
@@ -51,8 +109,8 @@ void main()
     vec3 result;
     
     // point lights
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(material, pointLights[i], N, Pos, V);
+    for(int i = 0; i < pointLightCount; i++)
+        result += CalcPointLight(m, pointLights[i], N, Pos, V);
     
     LightingColor = vec4(result, 1.0);
     
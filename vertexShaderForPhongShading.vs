@@ -1,19 +1,64 @@
 #version 330 core
+// VERTEX_COMPACT meshes store half float positions and 2_10_10_10 normals,
+// the attribute fetch expands both to the float vectors below
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
+// per-instance model matrix of the instanced cube draw
+layout (location = 2) in mat4 aInstanceModel;
+// material index, per instance or, in the baked static geometry, per vertex
+layout (location = 9) in uint aMaterialId;
+// per-instance normal matrix, computed on the CPU next to the model matrix
+layout (location = 10) in mat3 aInstanceNormalMatrix;
 
 out vec3 FragPos;
 out vec3 Normal;
+// the draw's material, looked up once per vertex instead of per fragment
+flat out vec3 MaterialAmbient;
+flat out vec3 MaterialDiffuse;
+flat out vec4 MaterialSpecular;
+flat out vec3 MaterialEmissive;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// transpose(inverse(mat3(model))) of single draws, see transform.h
+uniform mat3 normalMatrix;
+// material of single draws, an index into the Materials block
+uniform int materialId = 0;
+// true: model, normal matrix and material index come from the instance attributes instead of the uniforms
+uniform bool instanced = false;
+// true: already in world space (the material index still comes from the attribute)
+uniform bool bakedGeometry = false;
+// camera, written once per frame into the stream buffer
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every material of the scene, see materialTable.h
+struct MaterialEntry {
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;      // shininess in w
+    vec4 emissive;
+};
+layout (std140) uniform Materials
+{
+    MaterialEntry materials[256];
+};
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    mat4 M = bakedGeometry ? mat4(1.0) : (instanced ? aInstanceModel : model);
+    gl_Position = projection * view * M * vec4(aPos, 1.0);
     
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    FragPos = vec3(M * vec4(aPos, 1.0));
+    Normal = (bakedGeometry ? mat3(1.0) : (instanced ? aInstanceNormalMatrix : normalMatrix)) * aNormal;
+
+    MaterialEntry entry = materials[instanced ? aMaterialId : uint(materialId)];
+    MaterialAmbient = entry.ambient.rgb;
+    MaterialDiffuse = entry.diffuse.rgb;
+    MaterialSpecular = entry.specular;
+    MaterialEmissive = entry.emissive.rgb;
     
 }
@@ -0,0 +1,59 @@
+#version 430 core
+#extension GL_ARB_shader_draw_parameters : require
+// multi-draw indirect variant of vertexShaderForPhongShading.vs: model and material index
+// of every draw come from the storage buffer, indexed by the draw's position in the call
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+out vec3 FragPos;
+out vec3 Normal;
+flat out vec3 MaterialAmbient;
+flat out vec3 MaterialDiffuse;
+flat out vec4 MaterialSpecular;
+flat out vec3 MaterialEmissive;
+
+// camera, written once per frame into the stream buffer
+layout (std140) uniform FrameData
+{
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every material of the scene, see materialTable.h
+struct MaterialEntry {
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;      // shininess in w
+    vec4 emissive;
+};
+layout (std140) uniform Materials
+{
+    MaterialEntry materials[256];
+};
+
+struct DrawData {
+    mat4 model;
+    mat3 normalMatrix;  // transpose(inverse(mat3(model))), see transform.h
+    uint material;      // into the Materials block
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+    DrawData draws[];
+};
+
+void main()
+{
+    DrawData draw = draws[gl_DrawIDARB];
+    gl_Position = projection * view * draw.model * vec4(aPos, 1.0);
+
+    FragPos = vec3(draw.model * vec4(aPos, 1.0));
+    Normal = draw.normalMatrix * aNormal;
+
+    MaterialEntry entry = materials[draw.material];
+    MaterialAmbient = entry.ambient.rgb;
+    MaterialDiffuse = entry.diffuse.rgb;
+    MaterialSpecular = entry.specular;
+    MaterialEmissive = entry.emissive.rgb;
+}